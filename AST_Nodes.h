@@ -8,6 +8,10 @@ class Visitor;
 class AST_Node
 {
 public:
+    //source position of the statement, set by the parser (expressions keep 0)
+    int line = 0;
+    int column = 0;
+
     virtual void accept(Visitor &v) = 0;
 };
 
@@ -46,6 +50,120 @@ public:
     void accept(Visitor &v);
 };
 
+//PARALLEL FOR var = from TO to, the programmer promises the iterations are independent
+class ParallelFor : public AST_Node
+{
+public:
+    Token var;
+    AST_Node *from, *to;
+
+    AST_Node *bCode;
+
+    ParallelFor(Token v, AST_Node *f, AST_Node *t, AST_Node *b) : var(v), from(f), to(t), bCode(b){};
+
+    void accept(Visitor &v);
+};
+
+//REDUCE SUM target = expr FOR var = from TO to folds expr over the range into target,
+//MIN and MAX work the same way
+class Reduce : public AST_Node
+{
+public:
+    Token op;
+    Token target;
+    AST_Node *expr;
+
+    Token var;
+    AST_Node *from, *to;
+
+    Reduce(Token o, Token t, AST_Node *e, Token v, AST_Node *f, AST_Node *l) : op(o), target(t), expr(e), var(v), from(f), to(l){};
+
+    void accept(Visitor &v);
+};
+
+//ATOMIC ADD a[i], v, ATOMIC MIN and ATOMIC MAX update one element in place, safe against other threads.
+//ATOMIC CAS a[i], expected, desired TO ok stores desired only if the element equals expected and sets ok to 1 or 0
+class AtomicOp : public AST_Node
+{
+public:
+    Token op;
+    AST_Node *arr; //an Array node
+    AST_Node *expr;
+
+    AST_Node *desired; //CAS only
+    Token result;      //CAS only
+
+    AtomicOp(Token o, AST_Node *a, AST_Node *e, AST_Node *d, Token r) : op(o), arr(a), expr(e), desired(d), result(r){};
+
+    void accept(Visitor &v);
+};
+
+//SPAWN label starts a task that runs the program from the label to its end, next to the program itself.
+//SPAWN label, var = expr also gives the task its own variable holding the value of expr
+class Spawn : public AST_Node
+{
+public:
+    Token token;
+
+    Token var;
+    AST_Node *expr; //null without the variable
+
+    Spawn(Token t, Token v, AST_Node *e) : token(t), var(v), expr(e){};
+
+    void accept(Visitor &v);
+};
+
+//JOIN waits until every spawned task finished
+class Join : public AST_Node
+{
+public:
+    void accept(Visitor &v);
+};
+
+//YIELD lets the other tasks run, in the program it runs every task once
+class Yield : public AST_Node
+{
+public:
+    void accept(Visitor &v);
+};
+
+//CHAN c[capacity] declares a channel holding up to capacity values in the current scope
+class ChanDecl : public AST_Node
+{
+public:
+    Token chan;
+    AST_Node *capacity;
+
+    ChanDecl(Token c, AST_Node *cap) : chan(c), capacity(cap){};
+
+    void accept(Visitor &v);
+};
+
+//SEND c, expr puts the value at the end of the channel, a task waits while the channel is full
+class Send : public AST_Node
+{
+public:
+    Token chan;
+    AST_Node *expr;
+
+    Send(Token c, AST_Node *e) : chan(c), expr(e){};
+
+    void accept(Visitor &v);
+};
+
+//RECV c, x and RECV c, a[i] take the oldest value of the channel, a task waits while the channel is empty
+class Recv : public AST_Node
+{
+public:
+    Token chan;
+    AST_Node *var; //a Var node, or null when the target is an array element
+    AST_Node *arr; //an Array node, or null
+
+    Recv(Token c, AST_Node *v, AST_Node *a) : chan(c), var(v), arr(a){};
+
+    void accept(Visitor &v);
+};
+
 class GoTo : public AST_Node
 {
 public:
@@ -102,8 +220,11 @@ class ArrDecl : public AST_Node
 {
 public:
     AST_Node *arr;
+    //MAP with the file name in text_data for LET a[n] MAP "file", SPARSE for LET a[n] SPARSE,
+    //END for an array on the heap
+    Token storage;
 
-    ArrDecl(AST_Node *l) : arr(l){};
+    ArrDecl(AST_Node *l, Token s = Token{-1, Token::END}) : arr(l), storage(s){};
 
     void accept(Visitor &v);
 };
@@ -158,8 +279,8 @@ class Array : public AST_Node
 {
 public:
     Token token; //same as var, the array is characterized by id
-    AST_Node *index;
-    Array(Token t, AST_Node *ast) : token(t), index(ast){};
+    std::vector<AST_Node *> indices; //one expression per dimension, a[i][j] has two
+    Array(Token t, std::vector<AST_Node *> ast) : token(t), indices(ast){};
 
     void accept(Visitor &v);
 };
@@ -185,6 +306,107 @@ public:
     void accept(Visitor &v);
 };
 
+//ARRAY INTRINSICS
+//the arrays are named by their ID tokens and run over the whole flat storage whatever the rank
+
+//SUM(a, n), MAX(a, n) and MIN(a, n) over the first n elements, op holds which one
+class ArrReduce : public AST_Node
+{
+public:
+    Token op;
+    Token arr;
+    AST_Node *count;
+    ArrReduce(Token o, Token a, AST_Node *c) : op(o), arr(a), count(c){};
+
+    void accept(Visitor &v);
+};
+
+//DOT(a, b, n)
+class ArrDot : public AST_Node
+{
+public:
+    Token left, right;
+    AST_Node *count;
+    ArrDot(Token l, Token r, AST_Node *c) : left(l), right(r), count(c){};
+
+    void accept(Visitor &v);
+};
+
+//FILL a, v sets every element
+class ArrFill : public AST_Node
+{
+public:
+    Token arr;
+    AST_Node *expr;
+    ArrFill(Token a, AST_Node *e) : arr(a), expr(e){};
+
+    void accept(Visitor &v);
+};
+
+//COPY a TO b copies all of a into the start of b
+class ArrCopy : public AST_Node
+{
+public:
+    Token from, to;
+    ArrCopy(Token f, Token t) : from(f), to(t){};
+
+    void accept(Visitor &v);
+};
+
+//SORT a, n sorts the first n elements ascending in place
+class ArrSort : public AST_Node
+{
+public:
+    Token arr;
+    AST_Node *count;
+    ArrSort(Token a, AST_Node *c) : arr(a), count(c){};
+
+    void accept(Visitor &v);
+};
+
+//BSEARCH(a, n, key) is the position of key among the first n sorted elements or -1
+class ArrSearch : public AST_Node
+{
+public:
+    Token arr;
+    AST_Node *count;
+    AST_Node *key;
+    ArrSearch(Token a, AST_Node *c, AST_Node *k) : arr(a), count(c), key(k){};
+
+    void accept(Visitor &v);
+};
+
+//LOAD a FROM "file" and STORE a TO "file" move the array in one go, binary unless TEXT follows the keyword.
+//a count after a comma moves only the first count elements
+class ArrFile : public AST_Node
+{
+public:
+    Token op; //LOAD or STORE
+    Token arr;
+    Token file;
+    bool text;
+    AST_Node *count; //null for the whole array
+
+    ArrFile(Token o, Token a, Token f, bool t, AST_Node *c) : op(o), arr(a), file(f), text(t), count(c){};
+
+    void accept(Visitor &v);
+};
+
+//FOR key, val IN a runs the body once for every element of a that is not 0, in the order of the positions,
+//with key set to the row major position of the element and val to its value
+class ForEach : public AST_Node
+{
+public:
+    Token key;
+    Token val;
+    Token arr;
+    AST_Node *bCode;
+
+    ForEach(Token k, Token v, Token a, AST_Node *b) : key(k), val(v), arr(a), bCode(b){};
+
+    void accept(Visitor &v);
+};
+
 class NO_OP : public AST_Node
 {
 public:
@@ -215,6 +437,26 @@ public:
     virtual void visit(ArrAssign *ast) = 0;
     virtual void visit(VarDecl *ast) = 0;
     virtual void visit(ArrDecl *ast) = 0;
+
+    virtual void visit(ArrReduce *ast) = 0;
+    virtual void visit(ArrDot *ast) = 0;
+    virtual void visit(ArrFill *ast) = 0;
+    virtual void visit(ArrCopy *ast) = 0;
+    virtual void visit(ArrSort *ast) = 0;
+    virtual void visit(ArrSearch *ast) = 0;
+    virtual void visit(ArrFile *ast) = 0;
+    virtual void visit(ForEach *ast) = 0;
+
+    virtual void visit(ParallelFor *ast) = 0;
+    virtual void visit(Reduce *ast) = 0;
+    virtual void visit(AtomicOp *ast) = 0;
+
+    virtual void visit(Spawn *ast) = 0;
+    virtual void visit(Join *ast) = 0;
+    virtual void visit(Yield *ast) = 0;
+    virtual void visit(ChanDecl *ast) = 0;
+    virtual void visit(Send *ast) = 0;
+    virtual void visit(Recv *ast) = 0;
 };
 
 #include "AST_Nodes.inl"
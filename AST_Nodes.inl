@@ -91,4 +91,81 @@ inline void Array::accept(Visitor &v)
     v.visit(this);
 }
 
+inline void ArrReduce::accept(Visitor &v)
+{
+    v.visit(this);
+}
+
+inline void ArrDot::accept(Visitor &v)
+{
+    v.visit(this);
+}
+
+inline void ArrFill::accept(Visitor &v)
+{
+    v.visit(this);
+}
+
+inline void ArrCopy::accept(Visitor &v)
+{
+    v.visit(this);
+}
+
+inline void ArrSort::accept(Visitor &v)
+{
+    v.visit(this);
+}
+
+inline void ArrSearch::accept(Visitor &v)
+{
+    v.visit(this);
+}
+
+inline void ArrFile::accept(Visitor &v)
+{
+    v.visit(this);
+}
+
+inline void ParallelFor::accept(Visitor &v)
+{
+    v.visit(this);
+}
+
+inline void Reduce::accept(Visitor &v)
+{
+    v.visit(this);
+}
+inline void AtomicOp::accept(Visitor &v)
+{
+    v.visit(this);
+}
+inline void Spawn::accept(Visitor &v)
+{
+    v.visit(this);
+}
+inline void Join::accept(Visitor &v)
+{
+    v.visit(this);
+}
+inline void Yield::accept(Visitor &v)
+{
+    v.visit(this);
+}
+inline void ChanDecl::accept(Visitor &v)
+{
+    v.visit(this);
+}
+inline void Send::accept(Visitor &v)
+{
+    v.visit(this);
+}
+inline void Recv::accept(Visitor &v)
+{
+    v.visit(this);
+}
+inline void ForEach::accept(Visitor &v)
+{
+    v.visit(this);
+}
+
 #endif
\ No newline at end of file
@@ -3,41 +3,81 @@
 #ifndef STABLE_HEADER
 #define STABLE_HEADER
 
+//an array of any rank in one contiguous row major block
+struct ArrayStorage
+{
+    ArrayBuffer data;
+    std::vector<long long> dims;
+    std::vector<long long> strides; //computed once at declaration, the last dimension has stride 1
+
+    //LET a[n] SPARSE keeps its elements in a hash table by position and leaves data empty
+    bool sparse = false;
+    SparseArray elements;
+
+    //bounds checks the index of one dimension and returns how far it moves into data
+    long long offset(std::size_t dimension, const value_t &index) const;
+    //the declared number of elements
+    long long size() const;
+};
+
 class SymbolTable
 {
 public:
     void dec_var(std::string identifier);
-    void dec_arr(std::string identifier, int arr_size);
+    //storage is MAP to map the array onto file instead of allocating it, SPARSE for a hash table of its entries
+    void dec_arr(std::string identifier, const std::vector<value_t> &sizes, Token::type storage = Token::END,
+                 const std::string &file = std::string());
+    void dec_chan(std::string identifier, std::size_t capacity);
 
-    void modify_var(std::string identifier, int newvalue);
-    void modify_arr(std::string identifier, int index, int newvalue);
+    void modify_var(std::string identifier, value_t newvalue);
 
-    const int &lookup_var(std::string varname) const;
-    const int &lookup_arr(std::string arr_name, int index) const;
+    const value_t &lookup_var(std::string varname) const;
+    //element positions are resolved by the caller with ArrayStorage::offset
+    ArrayStorage &lookup_arr(std::string arr_name);
+    //channels are shared, a task blocked on one keeps it alive after its scope is gone
+    std::shared_ptr<Channel> lookup_chan(std::string chan_name) const;
 
     bool var_exists(std::string varname) const;
     bool arr_exists(std::string arrname) const;
+    bool chan_exists(std::string channame) const;
+
+    void clear();
 
 private:
-    std::unordered_map<std::string, int> vars;
-    std::unordered_map<std::string, std::vector<int>> arrays;
+    std::unordered_map<std::string, value_t> vars;
+    std::unordered_map<std::string, ArrayStorage> arrays;
+    std::unordered_map<std::string, std::shared_ptr<Channel>> channels;
 };
 
 class ScopedTable
 {
 public:
     void dec_var(std::string identifier);
-    void dec_arr(std::string identifier, int arr_size);
-    void modify_var(std::string identifier, int newvalue);
-    void modify_arr(std::string identifier, int index, int newvalue);
-    const int &lookup_var(std::string varname) const;
-    const int &lookup_arr(std::string arr_name, int index) const;
+    void dec_arr(std::string identifier, const std::vector<value_t> &sizes, Token::type storage = Token::END,
+                 const std::string &file = std::string());
+    void dec_chan(std::string identifier, std::size_t capacity);
+    void modify_var(std::string identifier, value_t newvalue);
+    const value_t &lookup_var(std::string varname) const;
+    ArrayStorage &lookup_arr(std::string arr_name);
+    std::shared_ptr<Channel> lookup_chan(std::string chan_name) const;
+    bool var_exists(std::string varname) const;
+    bool arr_exists(std::string arrname) const;
+    //true when the array was found in the outer table, so other threads may use it too
+    bool arr_is_shared(std::string arrname) const;
     void addScope();
     void removeScope();
     void back_to_global();
+    void clear();
     ScopedTable();
 
+    //used by the workers of a PARALLEL FOR and by tasks: variables of the enclosing program can be read but not assigned,
+    //arrays are shared. the outer table must not change while the workers run
+    void set_parent(ScopedTable *outer);
+
 private:
+    ScopedTable *parent;
+
+    //scopes above top are kept empty and reused, so loops don't allocate a new table every iteration
     int top;
     std::vector<SymbolTable> scopes;
 };
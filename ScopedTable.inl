@@ -1,18 +1,60 @@
 #ifndef STABLE_SOURCE
 #define STABLE_SOURCE
 
+inline long long ArrayStorage::offset(std::size_t dimension, const value_t &index) const
+{
+    long long i;
+    if (!value_fits_long(index, i) || i < 0 || i >= dims[dimension])
+        throw std::invalid_argument("cannot find the value at given index or array is not declared");
+
+    return i * strides[dimension];
+}
+
+inline long long ArrayStorage::size() const
+{
+    return dims[0] * strides[0];
+}
+
 inline void SymbolTable::dec_var(std::string identifier)
 {
     vars.insert({identifier, 0});
 }
-inline void SymbolTable::dec_arr(std::string identifier, int arr_size)
+inline void SymbolTable::dec_arr(std::string identifier, const std::vector<value_t> &sizes, Token::type storage, const std::string &file)
+{
+    ArrayStorage arr;
+    arr.dims.resize(sizes.size());
+    arr.strides.resize(sizes.size());
+
+    long long total = 1;
+    for (int i = (int)sizes.size() - 1; i >= 0; --i)
+    {
+        if (!value_fits_long(sizes[i], arr.dims[i]) || arr.dims[i] < 0)
+            throw std::invalid_argument("invalid array size");
+
+        arr.strides[i] = total;
+        if (__builtin_mul_overflow(total, arr.dims[i], &total))
+            throw std::invalid_argument("invalid array size");
+    }
+
+    if (storage == Token::SPARSE)
+        arr.sparse = true;
+    else if (storage == Token::MAP)
+        arr.data.map(file, total);
+    else
+        arr.data.assign(total, 0);
+    arrays.insert({identifier, std::move(arr)});
+}
+inline void SymbolTable::dec_chan(std::string identifier, std::size_t capacity)
 {
-    arrays.insert({identifier, std::vector<int>(arr_size, 0)});
+    if (capacity < 1)
+        throw std::invalid_argument("invalid channel capacity");
+
+    channels.insert({identifier, std::make_shared<Channel>(capacity)});
 }
 
-inline void SymbolTable::modify_var(std::string identifier, int newvalue)
+inline void SymbolTable::modify_var(std::string identifier, value_t newvalue)
 {
-    std::unordered_map<std::string, int>::iterator got = vars.find(identifier);
+    std::unordered_map<std::string, value_t>::iterator got = vars.find(identifier);
 
     if (got != vars.end())
     {
@@ -21,44 +63,44 @@ inline void SymbolTable::modify_var(std::string identifier, int newvalue)
     else
         throw std::invalid_argument("variable cannot be found");
 }
-inline void SymbolTable::modify_arr(std::string identifier, int index, int newvalue)
+
+inline const value_t &SymbolTable::lookup_var(std::string varname) const
 {
-    std::unordered_map<std::string, std::vector<int>>::iterator got = arrays.find(identifier);
+    std::unordered_map<std::string, value_t>::const_iterator got = vars.find(varname);
 
-    if (got != arrays.end() && index < got->second.size())
+    if (got != vars.end())
     {
-        got->second[index] = newvalue;
+        return got->second;
     }
     else
-        throw std::invalid_argument("cannot find the value at given index or array is not declared");
+        throw std::invalid_argument("variable cannot be found");
 }
-
-inline const int &SymbolTable::lookup_var(std::string varname) const
+inline ArrayStorage &SymbolTable::lookup_arr(std::string arr_name)
 {
-    std::unordered_map<std::string, int>::const_iterator got = vars.find(varname);
+    std::unordered_map<std::string, ArrayStorage>::iterator got = arrays.find(arr_name);
 
-    if (got != vars.end())
+    if (got != arrays.end())
     {
         return got->second;
     }
     else
-        throw std::invalid_argument("variable cannot be found");
+        throw std::invalid_argument("cannot find the value at given index or array is not declared");
 }
-inline const int &SymbolTable::lookup_arr(std::string arr_name, int index) const
+inline std::shared_ptr<Channel> SymbolTable::lookup_chan(std::string chan_name) const
 {
-    std::unordered_map<std::string, std::vector<int>>::const_iterator got = arrays.find(arr_name);
+    std::unordered_map<std::string, std::shared_ptr<Channel>>::const_iterator got = channels.find(chan_name);
 
-    if (got != arrays.end() && index < got->second.size())
+    if (got != channels.end())
     {
-        return got->second[index];
+        return got->second;
     }
     else
-        throw std::invalid_argument("cannot find the value at given index or array is not declared");
+        throw std::invalid_argument("channel is not declared");
 }
 
 inline bool SymbolTable::var_exists(std::string varname) const
 {
-    std::unordered_map<std::string, int>::const_iterator got = vars.find(varname);
+    std::unordered_map<std::string, value_t>::const_iterator got = vars.find(varname);
 
     if (got != vars.end())
         return true;
@@ -68,25 +110,41 @@ inline bool SymbolTable::var_exists(std::string varname) const
 
 inline bool SymbolTable::arr_exists(std::string arrname) const
 {
-    std::unordered_map<std::string, std::vector<int>>::const_iterator got = arrays.find(arrname);
+    std::unordered_map<std::string, ArrayStorage>::const_iterator got = arrays.find(arrname);
 
     if (got != arrays.end())
         return true;
     else
         return false;
 }
+
+inline bool SymbolTable::chan_exists(std::string channame) const
+{
+    return channels.find(channame) != channels.end();
+}
+
+inline void SymbolTable::clear()
+{
+    vars.clear();
+    arrays.clear();
+    channels.clear();
+}
 //SCOPED TABLE
 
 inline void ScopedTable::dec_var(std::string identifier)
 {
     scopes[top].dec_var(identifier);
 }
-inline void ScopedTable::dec_arr(std::string identifier, int arr_size)
+inline void ScopedTable::dec_arr(std::string identifier, const std::vector<value_t> &sizes, Token::type storage, const std::string &file)
 {
-    scopes[top].dec_arr(identifier, arr_size);
+    scopes[top].dec_arr(identifier, sizes, storage, file);
+}
+inline void ScopedTable::dec_chan(std::string identifier, std::size_t capacity)
+{
+    scopes[top].dec_chan(identifier, capacity);
 }
 
-inline void ScopedTable::modify_var(std::string identifier, int newvalue)
+inline void ScopedTable::modify_var(std::string identifier, value_t newvalue)
 {
     for (int i = 0; i <= top; ++i)
     {
@@ -97,71 +155,133 @@ inline void ScopedTable::modify_var(std::string identifier, int newvalue)
         }
     }
 
+    if (parent)
+        throw std::invalid_argument("PARALLEL FOR bodies and tasks cannot assign variables declared outside them");
+
     throw std::invalid_argument("something went wrong");
 }
-inline void ScopedTable::modify_arr(std::string identifier, int index, int newvalue)
+
+inline const value_t &ScopedTable::lookup_var(std::string varname) const
 {
     for (int i = 0; i <= top; ++i)
     {
-        if (scopes[i].arr_exists(identifier))
+        if (scopes[i].var_exists(varname))
         {
-            scopes[i].modify_arr(identifier, index, newvalue);
-            return;
+            return scopes[i].lookup_var(varname);
         }
     }
 
+    if (parent)
+        return parent->lookup_var(varname);
+
     throw std::invalid_argument("something went wrong");
 }
 
-inline const int &ScopedTable::lookup_var(std::string varname) const
+inline ArrayStorage &ScopedTable::lookup_arr(std::string arr_name)
 {
     for (int i = 0; i <= top; ++i)
     {
-        if (scopes[i].var_exists(varname))
+        if (scopes[i].arr_exists(arr_name))
         {
-            return scopes[i].lookup_var(varname);
+            return scopes[i].lookup_arr(arr_name);
         }
     }
 
+    if (parent)
+        return parent->lookup_arr(arr_name);
+
     throw std::invalid_argument("something went wrong");
 }
 
-inline const int &ScopedTable::lookup_arr(std::string arr_name, int index) const
+inline std::shared_ptr<Channel> ScopedTable::lookup_chan(std::string chan_name) const
 {
     for (int i = 0; i <= top; ++i)
     {
-        if (scopes[i].arr_exists(arr_name))
+        if (scopes[i].chan_exists(chan_name))
         {
-            return scopes[i].lookup_arr(arr_name, index);
+            return scopes[i].lookup_chan(chan_name);
         }
     }
 
-    throw std::invalid_argument("something went wrong");
+    if (parent)
+        return parent->lookup_chan(chan_name);
+
+    throw std::invalid_argument("channel is not declared");
 }
 
-inline void ScopedTable::addScope()
+inline bool ScopedTable::var_exists(std::string varname) const
+{
+    for (int i = 0; i <= top; ++i)
+        if (scopes[i].var_exists(varname))
+            return true;
+
+    return parent && parent->var_exists(varname);
+}
+
+inline bool ScopedTable::arr_exists(std::string arrname) const
+{
+    for (int i = 0; i <= top; ++i)
+        if (scopes[i].arr_exists(arrname))
+            return true;
+
+    return parent && parent->arr_exists(arrname);
+}
+
+inline bool ScopedTable::arr_is_shared(std::string arrname) const
 {
-    SymbolTable _new;
-    scopes.push_back(_new);
+    for (int i = 0; i <= top; ++i)
+        if (scopes[i].arr_exists(arrname))
+            return false;
+
+    return parent != nullptr;
+}
 
+inline void ScopedTable::addScope()
+{
     ++top;
+
+    if (top == scopes.size())
+    {
+        SymbolTable _new;
+        scopes.push_back(_new);
+    }
 }
 
 inline void ScopedTable::removeScope()
 {
+    //a GOTO may already have dropped back to the global scope while the blocks unwind
+    if (top == 0)
+        return;
+
+    scopes[top].clear();
     --top;
 }
 
 inline void ScopedTable::back_to_global()
 {
+    for (int i = 1; i <= top; ++i)
+        scopes[i].clear();
+
+    top = 0;
+}
+
+inline void ScopedTable::clear()
+{
+    for (int i = 0; i <= top; ++i)
+        scopes[i].clear();
+
     top = 0;
 }
 
-inline ScopedTable::ScopedTable() : top(0)
+inline ScopedTable::ScopedTable() : parent(nullptr), top(0)
 {
     SymbolTable global_scope;
     scopes.push_back(global_scope);
 }
 
+inline void ScopedTable::set_parent(ScopedTable *outer)
+{
+    parent = outer;
+}
 
 #endif
\ No newline at end of file
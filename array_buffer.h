@@ -0,0 +1,69 @@
+#pragma once
+
+#ifndef ARRAY_BUFFER_HEADER
+#define ARRAY_BUFFER_HEADER
+
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+////ARRAY BUFFERS////
+//the elements of an array: a heap block, or a file mapped into memory for LET a[n] MAP "file".
+//a mapped file holds the raw values in the machine's byte order (4 byte integers by default,
+//8 bytes with -DBASIC_INT64 and -DBASIC_NANBOX) and is read and written in place,
+//so an array can be larger than memory and its pages are loaded and written back by the kernel
+class ArrayBuffer
+{
+public:
+    ArrayBuffer();
+    ~ArrayBuffer();
+
+    ArrayBuffer(ArrayBuffer &&other);
+    ArrayBuffer &operator=(ArrayBuffer &&other);
+    //a mapped buffer is copied into a heap block
+    ArrayBuffer(const ArrayBuffer &other);
+    ArrayBuffer &operator=(const ArrayBuffer &other);
+
+    //a heap block of count copies of v
+    void assign(std::size_t count, const value_t &v);
+    //maps count elements of the file, creating it or growing it with zeros when it is shorter
+    void map(const std::string &path, std::size_t count);
+
+    value_t &operator[](std::size_t i);
+    const value_t &operator[](std::size_t i) const;
+    value_t *data();
+    const value_t *data() const;
+    std::size_t size() const;
+
+    bool mapped() const;
+    //whether the buffer maps the file at path, which must then be written back with sync() instead of rewritten
+    bool maps(const std::string &path) const;
+    //writes the mapped pages back to the file
+    void sync() const;
+    //asks the kernel to start reading the first count elements, the built-ins call it before a whole array scan
+    void will_scan(std::size_t count) const;
+
+private:
+    std::vector<value_t> heap;
+
+    value_t *values;
+    std::size_t count;
+    void *mapping; //null for heap blocks
+    std::size_t mapping_size;
+    dev_t device; //the mapped file
+    ino_t inode;
+
+    void unmap();
+};
+
+#include "array_buffer.inl"
+
+#endif
\ No newline at end of file
@@ -0,0 +1,194 @@
+#ifndef ARRAY_BUFFER_SOURCE
+#define ARRAY_BUFFER_SOURCE
+
+inline ArrayBuffer::ArrayBuffer() : values(nullptr), count(0), mapping(nullptr), mapping_size(0), device(0), inode(0)
+{
+}
+
+inline ArrayBuffer::~ArrayBuffer()
+{
+    unmap();
+}
+
+inline ArrayBuffer::ArrayBuffer(ArrayBuffer &&other)
+    : heap(std::move(other.heap)), values(other.values), count(other.count), mapping(other.mapping), mapping_size(other.mapping_size),
+      device(other.device), inode(other.inode)
+{
+    if (!mapping)
+        values = heap.data();
+
+    other.values = nullptr;
+    other.count = 0;
+    other.mapping = nullptr;
+    other.mapping_size = 0;
+}
+
+inline ArrayBuffer &ArrayBuffer::operator=(ArrayBuffer &&other)
+{
+    if (this != &other)
+    {
+        unmap();
+
+        heap = std::move(other.heap);
+        mapping = other.mapping;
+        mapping_size = other.mapping_size;
+        device = other.device;
+        inode = other.inode;
+        count = other.count;
+        values = mapping ? other.values : heap.data();
+
+        other.values = nullptr;
+        other.count = 0;
+        other.mapping = nullptr;
+        other.mapping_size = 0;
+    }
+
+    return *this;
+}
+
+inline ArrayBuffer::ArrayBuffer(const ArrayBuffer &other)
+    : heap(other.values, other.values + other.count), count(other.count), mapping(nullptr), mapping_size(0), device(0), inode(0)
+{
+    values = heap.data();
+}
+
+inline ArrayBuffer &ArrayBuffer::operator=(const ArrayBuffer &other)
+{
+    if (this != &other)
+        *this = ArrayBuffer(other);
+
+    return *this;
+}
+
+inline void ArrayBuffer::unmap()
+{
+    if (mapping)
+        munmap(mapping, mapping_size);
+
+    mapping = nullptr;
+    mapping_size = 0;
+}
+
+inline void ArrayBuffer::assign(std::size_t _count, const value_t &v)
+{
+    unmap();
+
+    heap.assign(_count, v);
+    values = heap.data();
+    count = _count;
+}
+
+inline void ArrayBuffer::map(const std::string &path, std::size_t _count)
+{
+    if constexpr (!std::is_trivially_copyable<value_t>::value)
+        throw std::invalid_argument("MAP arrays need fixed size values, they don't work with -DBASIC_BIGINT");
+    else
+    {
+        if (_count > SIZE_MAX / sizeof(value_t))
+            throw std::invalid_argument("invalid array size");
+        std::size_t bytes = _count * sizeof(value_t);
+
+        int fd = open(path.c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+        if (fd < 0)
+            throw std::invalid_argument("cannot open the file of a MAP array");
+
+        struct stat info = {};
+        std::size_t old_size = 0;
+        if (fstat(fd, &info) == 0)
+            old_size = info.st_size;
+
+        if (old_size < bytes && ftruncate(fd, bytes) < 0)
+        {
+            close(fd);
+            throw std::invalid_argument("cannot grow the file of a MAP array");
+        }
+
+        //a mapping can't be empty, a zero element array keeps no mapping
+        void *address = nullptr;
+        if (bytes)
+        {
+            address = mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_NORESERVE, fd, 0);
+            if (address == MAP_FAILED)
+            {
+                close(fd);
+                throw std::invalid_argument("cannot map the file of a MAP array");
+            }
+        }
+        close(fd);
+
+        unmap();
+        heap.clear();
+        heap.shrink_to_fit();
+
+        mapping = address;
+        mapping_size = bytes;
+        device = info.st_dev;
+        inode = info.st_ino;
+        values = (value_t *)address;
+        count = _count;
+
+        //scans are the common case: read ahead aggressively and drop pages soon after they were used
+        if (bytes)
+            madvise(mapping, mapping_size, MADV_SEQUENTIAL);
+
+        //the file grew with zero bytes, which are not the value 0 in every build
+        value_t zero = 0;
+        unsigned char zero_bytes[sizeof(value_t)] = {};
+        if (std::memcmp(&zero, zero_bytes, sizeof(value_t)) != 0)
+            for (std::size_t i = old_size / sizeof(value_t); i < count; ++i)
+                values[i] = zero;
+    }
+}
+
+inline value_t &ArrayBuffer::operator[](std::size_t i)
+{
+    return values[i];
+}
+
+inline const value_t &ArrayBuffer::operator[](std::size_t i) const
+{
+    return values[i];
+}
+
+inline value_t *ArrayBuffer::data()
+{
+    return values;
+}
+
+inline const value_t *ArrayBuffer::data() const
+{
+    return values;
+}
+
+inline std::size_t ArrayBuffer::size() const
+{
+    return count;
+}
+
+inline bool ArrayBuffer::mapped() const
+{
+    return mapping != nullptr;
+}
+
+inline bool ArrayBuffer::maps(const std::string &path) const
+{
+    struct stat info;
+    return mapping && stat(path.c_str(), &info) == 0 && info.st_dev == device && info.st_ino == inode;
+}
+
+inline void ArrayBuffer::sync() const
+{
+    if (mapping && msync(mapping, mapping_size, MS_SYNC) < 0)
+        throw std::invalid_argument("cannot write back the file of a MAP array");
+}
+
+inline void ArrayBuffer::will_scan(std::size_t elements) const
+{
+    if (!mapping || !elements)
+        return;
+
+    std::size_t bytes = std::min(elements, count) * sizeof(value_t);
+    madvise(mapping, bytes, MADV_WILLNEED);
+}
+
+#endif
\ No newline at end of file
@@ -0,0 +1,44 @@
+#pragma once
+
+#ifndef ARRAY_IO_HEADER
+#define ARRAY_IO_HEADER
+
+#include <atomic>
+#include <cerrno>
+#include <charconv>
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+////ARRAY FILES////
+//LOAD and STORE move arrays between memory and files in large blocks instead of one READ per element.
+//binary files hold the raw values in the layout MAP files use (4 byte integers by default, 8 bytes with
+//-DBASIC_INT64 and -DBASIC_NANBOX, little endian on x86 and ARM) and are read straight into the array;
+//-DBASIC_BIGINT builds use 8 byte little endian integers. text files hold one number per line
+
+//count -1 loads every value of the file, which then must fit the array; otherwise the first count values are loaded.
+//returns how many values were loaded
+std::size_t load_array(const std::string &path, bool text, value_t *to, std::size_t capacity, long long count);
+//the values go to a new file that then replaces the old one, so a MAP array of the old file keeps its pages.
+//the new file keeps the old one's permissions, a file that didn't exist gets 0666 less the umask
+void store_array(const std::string &path, bool text, const value_t *from, std::size_t count);
+
+//one number of a text file: digits with an optional minus, decimals only in BASIC_NANBOX builds
+value_t parse_array_value(const char *begin, const char *end);
+
+//reads until size bytes arrived or the file ended, returns how many bytes were read
+std::size_t read_fully(int fd, char *data, std::size_t size);
+void write_fully(int fd, const char *data, std::size_t size);
+
+//the block size of text files and of the converted binary files of BASIC_BIGINT builds
+static const std::size_t ARRAY_IO_BLOCK = 1 << 20;
+
+#include "array_io.inl"
+
+#endif
\ No newline at end of file
@@ -0,0 +1,313 @@
+#ifndef ARRAY_IO_SOURCE
+#define ARRAY_IO_SOURCE
+
+inline std::size_t read_fully(int fd, char *data, std::size_t size)
+{
+    std::size_t done = 0;
+    while (done < size)
+    {
+        ssize_t got = read(fd, data + done, size - done);
+        if (got < 0 && errno == EINTR)
+            continue;
+        if (got < 0)
+            throw std::invalid_argument("cannot read array file");
+        if (got == 0)
+            break;
+
+        done += got;
+    }
+    return done;
+}
+
+inline void write_fully(int fd, const char *data, std::size_t size)
+{
+    while (size)
+    {
+        ssize_t put = write(fd, data, size);
+        if (put < 0 && errno == EINTR)
+            continue;
+        if (put < 0)
+            throw std::invalid_argument("cannot write array file");
+
+        data += put;
+        size -= put;
+    }
+}
+
+//up to 18 digits fit a long long whatever they are, longer numbers go through the overflow checks of value_t
+inline value_t parse_array_value(const char *begin, const char *end)
+{
+    const char *p = begin;
+    bool negative = p < end && *p == '-';
+    if (negative)
+        ++p;
+
+    long long small = 0;
+    const char *digits = p;
+    while (p < end && p - digits < 18 && *p >= '0' && *p <= '9')
+    {
+        small = small * 10 + (*p - '0');
+        ++p;
+    }
+
+    if (p == end && p > digits)
+        return value_from_long(negative ? -small : small);
+
+    while (p < end && *p >= '0' && *p <= '9')
+        ++p;
+
+    if (p == end && p > digits)
+        return value_from_digits(digits, end, negative);
+
+    if (p > digits && p + 1 < end && *p == '.')
+    {
+        const char *fraction = ++p;
+        while (p < end && *p >= '0' && *p <= '9')
+            ++p;
+
+        if (p == end && p > fraction)
+            return value_from_decimal(std::string(begin, end));
+    }
+
+    throw std::invalid_argument("invalid number in array file");
+}
+
+inline static bool array_io_space(char c)
+{
+    return c == '\n' || c == ' ' || c == '\r' || c == '\t';
+}
+
+//the numbers are parsed where they lie in the block, only one cut by the block's end is copied
+inline static std::size_t load_text(int fd, value_t *to, std::size_t capacity, long long count)
+{
+    std::size_t limit = count < 0 ? capacity : (std::size_t)count;
+    std::vector<char> block(ARRAY_IO_BLOCK);
+    std::string partial;
+    std::size_t loaded = 0;
+
+    auto emit = [&](const char *begin, const char *end) {
+        if (loaded == limit)
+        {
+            if (count < 0)
+                throw std::invalid_argument("the file holds more values than the array");
+            return false;
+        }
+
+        to[loaded++] = parse_array_value(begin, end);
+        return true;
+    };
+
+    while (true)
+    {
+        std::size_t got = read_fully(fd, block.data(), block.size());
+        const char *p = block.data(), *end = p + got;
+
+        if (!partial.empty())
+        {
+            while (p < end && !array_io_space(*p))
+                partial.push_back(*p++);
+
+            if (p < end || got < block.size())
+            {
+                if (!emit(partial.data(), partial.data() + partial.size()))
+                    return loaded;
+                partial.clear();
+            }
+        }
+
+        while (p < end)
+        {
+            while (p < end && array_io_space(*p))
+                ++p;
+
+            const char *start = p;
+            while (p < end && !array_io_space(*p))
+                ++p;
+
+            if (p == end && got == block.size())
+                partial.assign(start, p);
+            else if (start < p && !emit(start, p))
+                return loaded;
+        }
+
+        if (got < block.size())
+            break;
+    }
+
+    if (count >= 0 && loaded < (std::size_t)count)
+        throw std::invalid_argument("the file holds fewer values than the count");
+
+    return loaded;
+}
+
+inline static std::size_t load_binary(int fd, value_t *to, std::size_t capacity, long long count)
+{
+    const std::size_t width = std::is_trivially_copyable<value_t>::value ? sizeof(value_t) : sizeof(std::int64_t);
+
+    struct stat info;
+    if (fstat(fd, &info) < 0)
+        throw std::invalid_argument("cannot read array file");
+    if (info.st_size % width)
+        throw std::invalid_argument("the size of a binary array file must be a multiple of the value size");
+
+    std::size_t available = info.st_size / width;
+    std::size_t wanted = count < 0 ? available : (std::size_t)count;
+    if (wanted > available)
+        throw std::invalid_argument("the file holds fewer values than the count");
+    if (wanted > capacity)
+        throw std::invalid_argument("the file holds more values than the array");
+
+    posix_fadvise(fd, 0, 0, POSIX_FADV_SEQUENTIAL);
+
+    if constexpr (std::is_trivially_copyable<value_t>::value)
+    {
+        if (read_fully(fd, (char *)to, wanted * width) != wanted * width)
+            throw std::invalid_argument("cannot read array file");
+    }
+    else
+    {
+        std::vector<unsigned char> block(ARRAY_IO_BLOCK);
+        for (std::size_t done = 0; done < wanted;)
+        {
+            std::size_t now = std::min(wanted - done, block.size() / width);
+            if (read_fully(fd, (char *)block.data(), now * width) != now * width)
+                throw std::invalid_argument("cannot read array file");
+
+            for (std::size_t i = 0; i < now; ++i)
+            {
+                std::uint64_t bits = 0;
+                for (int b = 7; b >= 0; --b)
+                    bits = (bits << 8) | block[i * width + b];
+                to[done + i] = value_from_long((long long)bits);
+            }
+            done += now;
+        }
+    }
+
+    return wanted;
+}
+
+inline std::size_t load_array(const std::string &path, bool text, value_t *to, std::size_t capacity, long long count)
+{
+    int fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0)
+        throw std::invalid_argument("cannot open array file");
+
+    try
+    {
+        std::size_t loaded = text ? load_text(fd, to, capacity, count) : load_binary(fd, to, capacity, count);
+        close(fd);
+        return loaded;
+    }
+    catch (...)
+    {
+        close(fd);
+        throw;
+    }
+}
+
+//plain integers are formatted in place, the other value types know how to print themselves
+template <class T>
+inline void append_array_value(std::string &block, const T &v)
+{
+    if constexpr (std::is_integral<T>::value)
+    {
+        char digits[24];
+        char *end = std::to_chars(digits, digits + sizeof(digits), v).ptr;
+        block.append(digits, end);
+    }
+    else
+        block += value_to_string(v);
+}
+
+inline static void store_text(int fd, const value_t *from, std::size_t count)
+{
+    std::string block;
+    block.reserve(ARRAY_IO_BLOCK + 64);
+
+    for (std::size_t i = 0; i < count; ++i)
+    {
+        append_array_value(block, from[i]);
+        block.push_back('\n');
+
+        if (block.size() >= ARRAY_IO_BLOCK)
+        {
+            write_fully(fd, block.data(), block.size());
+            block.clear();
+        }
+    }
+
+    write_fully(fd, block.data(), block.size());
+}
+
+inline static void store_binary(int fd, const value_t *from, std::size_t count)
+{
+    if constexpr (std::is_trivially_copyable<value_t>::value)
+        write_fully(fd, (const char *)from, count * sizeof(value_t));
+    else
+    {
+        std::vector<char> block;
+        block.reserve(ARRAY_IO_BLOCK);
+
+        for (std::size_t i = 0; i < count; ++i)
+        {
+            long long v;
+            if (!value_fits_long(from[i], v))
+                throw std::overflow_error("a value does not fit the 64 bits of a binary array file");
+
+            for (int b = 0; b < 8; ++b)
+                block.push_back((char)((std::uint64_t)v >> (8 * b)));
+
+            if (block.size() >= ARRAY_IO_BLOCK)
+            {
+                write_fully(fd, block.data(), block.size());
+                block.clear();
+            }
+        }
+
+        write_fully(fd, block.data(), block.size());
+    }
+}
+
+inline void store_array(const std::string &path, bool text, const value_t *from, std::size_t count)
+{
+    //truncating the file in place would cut the pages out from under every mapping of it.
+    //the temporary name is made unique by hand instead of with mkstemp, whose 0600 would ignore the umask
+    static std::atomic<unsigned> stores(0);
+    std::string temporary;
+    int fd;
+    do
+    {
+        temporary = path + "." + std::to_string(getpid()) + "." + std::to_string(stores++) + ".tmp";
+        fd = open(temporary.c_str(), O_WRONLY | O_CREAT | O_EXCL | O_CLOEXEC, 0666);
+    } while (fd < 0 && errno == EEXIST);
+
+    if (fd < 0)
+        throw std::invalid_argument("cannot open array file");
+
+    try
+    {
+        struct stat old;
+        if (stat(path.c_str(), &old) == 0)
+            fchmod(fd, old.st_mode & 07777);
+
+        if (text)
+            store_text(fd, from, count);
+        else
+            store_binary(fd, from, count);
+    }
+    catch (...)
+    {
+        close(fd);
+        unlink(temporary.c_str());
+        throw;
+    }
+
+    if (close(fd) < 0 || rename(temporary.c_str(), path.c_str()) < 0)
+    {
+        unlink(temporary.c_str());
+        throw std::invalid_argument("cannot write array file");
+    }
+}
+
+#endif
\ No newline at end of file
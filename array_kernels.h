@@ -0,0 +1,50 @@
+#pragma once
+
+#ifndef ARRAY_KERNELS_HEADER
+#define ARRAY_KERNELS_HEADER
+
+#include <algorithm>
+#include <stdexcept>
+#include <type_traits>
+
+#include "value.h"
+
+#ifdef __AVX2__
+#include <immintrin.h>
+#endif
+
+////ARRAY KERNELS////
+//whole array loops behind SUM, MAX, MIN, DOT, FILL and COPY. int and long long storage gets AVX2
+//versions when the compiler targets it, every other element type goes through the scalar templates.
+//SUM and DOT of int and long long storage add up in 128 bits and throw std::overflow_error only when
+//the total doesn't fit, so the order the vector lanes add in never changes the result; other value
+//types are added one element after the other with the interpreter's own checked operators.
+
+template <class T>
+T array_sum(const T *data, long long n);
+//n must be at least 1
+template <class T>
+T array_max(const T *data, long long n);
+template <class T>
+T array_min(const T *data, long long n);
+template <class T>
+T array_dot(const T *a, const T *b, long long n);
+
+template <class T>
+void array_fill(T *data, long long n, const T &v);
+template <class T>
+void array_copy(const T *from, long long n, T *to);
+
+#ifdef __AVX2__
+int array_sum(const int *data, long long n);
+long long array_sum(const long long *data, long long n);
+int array_max(const int *data, long long n);
+long long array_max(const long long *data, long long n);
+int array_min(const int *data, long long n);
+long long array_min(const long long *data, long long n);
+int array_dot(const int *a, const int *b, long long n);
+#endif
+
+#include "array_kernels.inl"
+
+#endif
\ No newline at end of file
@@ -0,0 +1,360 @@
+#ifndef ARRAY_KERNELS_SOURCE
+#define ARRAY_KERNELS_SOURCE
+
+//SCALAR
+
+//the builtin types are checked here because the batch lanes are int even when value_t is not
+inline int kernel_add(int a, int b)
+{
+    int result;
+    if (__builtin_add_overflow(a, b, &result))
+        throw std::overflow_error("integer overflow");
+
+    return result;
+}
+
+inline long long kernel_add(long long a, long long b)
+{
+    long long result;
+    if (__builtin_add_overflow(a, b, &result))
+        throw std::overflow_error("integer overflow");
+
+    return result;
+}
+
+template <class T>
+inline T kernel_add(const T &a, const T &b)
+{
+    return value_add(a, b);
+}
+
+inline int kernel_mul(int a, int b)
+{
+    int result;
+    if (__builtin_mul_overflow(a, b, &result))
+        throw std::overflow_error("integer overflow");
+
+    return result;
+}
+
+inline long long kernel_mul(long long a, long long b)
+{
+    long long result;
+    if (__builtin_mul_overflow(a, b, &result))
+        throw std::overflow_error("integer overflow");
+
+    return result;
+}
+
+template <class T>
+inline T kernel_mul(const T &a, const T &b)
+{
+    return value_mul(a, b);
+}
+
+//the accumulator of SUM and DOT: int and long long totals are kept in 128 bits
+template <class T>
+struct KernelWide
+{
+    typedef T type;
+};
+
+template <>
+struct KernelWide<int>
+{
+    typedef __int128 type;
+};
+
+template <>
+struct KernelWide<long long>
+{
+    typedef __int128 type;
+};
+
+//a sum of 64 bit values can't leave 128 bits, only dot products of long longs can
+inline __int128 kernel_add(__int128 a, __int128 b)
+{
+    __int128 result;
+    if (__builtin_add_overflow(a, b, &result))
+        throw std::overflow_error("integer overflow");
+
+    return result;
+}
+
+template <class T>
+inline T kernel_narrow(const typename KernelWide<T>::type &total)
+{
+    if constexpr (std::is_same<typename KernelWide<T>::type, T>::value)
+        return total;
+    else
+    {
+        if (total != (T)total)
+            throw std::overflow_error("integer overflow");
+
+        return (T)total;
+    }
+}
+
+template <class T>
+inline T array_sum(const T *data, long long n)
+{
+    typedef typename KernelWide<T>::type Wide;
+
+    Wide total = 0;
+    for (long long i = 0; i < n; ++i)
+        total = kernel_add(total, (Wide)data[i]);
+
+    return kernel_narrow<T>(total);
+}
+
+template <class T>
+inline T array_max(const T *data, long long n)
+{
+    T best = data[0];
+    for (long long i = 1; i < n; ++i)
+    {
+        if (best < data[i])
+            best = data[i];
+    }
+
+    return best;
+}
+
+template <class T>
+inline T array_min(const T *data, long long n)
+{
+    T best = data[0];
+    for (long long i = 1; i < n; ++i)
+    {
+        if (data[i] < best)
+            best = data[i];
+    }
+
+    return best;
+}
+
+//products of two 64 bit values always fit 128 bits, the builtin types multiply without a check
+template <class T>
+inline T array_dot(const T *a, const T *b, long long n)
+{
+    typedef typename KernelWide<T>::type Wide;
+
+    Wide total = 0;
+    for (long long i = 0; i < n; ++i)
+    {
+        if constexpr (std::is_same<Wide, T>::value)
+            total = kernel_add(total, kernel_mul(a[i], b[i]));
+        else
+            total = kernel_add(total, (Wide)a[i] * b[i]);
+    }
+
+    return kernel_narrow<T>(total);
+}
+
+//fill_n and copy turn into vectorized stores or memmove for the builtin types on their own
+template <class T>
+inline void array_fill(T *data, long long n, const T &v)
+{
+    std::fill_n(data, n, v);
+}
+
+template <class T>
+inline void array_copy(const T *from, long long n, T *to)
+{
+    if (from != to)
+        std::copy(from, from + n, to);
+}
+
+#ifdef __AVX2__
+
+//AVX2
+
+//the four 64 bit lanes added in 128 bits
+inline __int128 kernel_horizontal_sum(__m256i v)
+{
+    alignas(32) long long lanes[4];
+    _mm256_store_si256((__m256i *)lanes, v);
+
+    return (__int128)lanes[0] + lanes[1] + lanes[2] + lanes[3];
+}
+
+//a signed add overflowed when the result's sign differs from the sign of both operands
+inline __m256i kernel_add_overflow(__m256i a, __m256i b, __m256i result)
+{
+    return _mm256_and_si256(_mm256_xor_si256(a, result), _mm256_xor_si256(b, result));
+}
+
+inline bool kernel_any_sign(__m256i v)
+{
+    return _mm256_movemask_pd(_mm256_castsi256_pd(v)) != 0;
+}
+
+//ints are widened to 64 bit lanes, which cannot overflow below 2^32 elements
+inline int array_sum(const int *data, long long n)
+{
+    __m256i low = _mm256_setzero_si256();
+    __m256i high = _mm256_setzero_si256();
+
+    long long i = 0;
+    for (; i + 8 <= n; i += 8)
+    {
+        __m256i v = _mm256_loadu_si256((const __m256i *)(data + i));
+        low = _mm256_add_epi64(low, _mm256_cvtepi32_epi64(_mm256_castsi256_si128(v)));
+        high = _mm256_add_epi64(high, _mm256_cvtepi32_epi64(_mm256_extracti128_si256(v, 1)));
+    }
+
+    __int128 total = kernel_horizontal_sum(_mm256_add_epi64(low, high));
+    for (; i < n; ++i)
+        total += data[i];
+
+    return kernel_narrow<int>(total);
+}
+
+inline long long array_sum(const long long *data, long long n)
+{
+    __m256i total = _mm256_setzero_si256();
+    __m256i overflow = _mm256_setzero_si256();
+
+    long long i = 0;
+    for (; i + 4 <= n; i += 4)
+    {
+        __m256i v = _mm256_loadu_si256((const __m256i *)(data + i));
+        __m256i result = _mm256_add_epi64(total, v);
+        overflow = _mm256_or_si256(overflow, kernel_add_overflow(total, v, result));
+        total = result;
+    }
+
+    //a lane that left 64 bits says nothing about the total, the scalar loop adds it up exactly
+    if (kernel_any_sign(overflow))
+        return array_sum<long long>(data, n);
+
+    __int128 result = kernel_horizontal_sum(total);
+    for (; i < n; ++i)
+        result += data[i];
+
+    return kernel_narrow<long long>(result);
+}
+
+inline int array_max(const int *data, long long n)
+{
+    if (n < 8)
+        return array_max<int>(data, n);
+
+    __m256i best = _mm256_loadu_si256((const __m256i *)data);
+
+    long long i = 8;
+    for (; i + 8 <= n; i += 8)
+        best = _mm256_max_epi32(best, _mm256_loadu_si256((const __m256i *)(data + i)));
+
+    alignas(32) int lanes[8];
+    _mm256_store_si256((__m256i *)lanes, best);
+
+    int result = array_max<int>(lanes, 8);
+    for (; i < n; ++i)
+        result = std::max(result, data[i]);
+
+    return result;
+}
+
+inline int array_min(const int *data, long long n)
+{
+    if (n < 8)
+        return array_min<int>(data, n);
+
+    __m256i best = _mm256_loadu_si256((const __m256i *)data);
+
+    long long i = 8;
+    for (; i + 8 <= n; i += 8)
+        best = _mm256_min_epi32(best, _mm256_loadu_si256((const __m256i *)(data + i)));
+
+    alignas(32) int lanes[8];
+    _mm256_store_si256((__m256i *)lanes, best);
+
+    int result = array_min<int>(lanes, 8);
+    for (; i < n; ++i)
+        result = std::min(result, data[i]);
+
+    return result;
+}
+
+//AVX2 has no 64 bit max or min, a compare and a blend do the same
+inline long long array_max(const long long *data, long long n)
+{
+    if (n < 4)
+        return array_max<long long>(data, n);
+
+    __m256i best = _mm256_loadu_si256((const __m256i *)data);
+
+    long long i = 4;
+    for (; i + 4 <= n; i += 4)
+    {
+        __m256i v = _mm256_loadu_si256((const __m256i *)(data + i));
+        best = _mm256_blendv_epi8(best, v, _mm256_cmpgt_epi64(v, best));
+    }
+
+    alignas(32) long long lanes[4];
+    _mm256_store_si256((__m256i *)lanes, best);
+
+    long long result = array_max<long long>(lanes, 4);
+    for (; i < n; ++i)
+        result = std::max(result, data[i]);
+
+    return result;
+}
+
+inline long long array_min(const long long *data, long long n)
+{
+    if (n < 4)
+        return array_min<long long>(data, n);
+
+    __m256i best = _mm256_loadu_si256((const __m256i *)data);
+
+    long long i = 4;
+    for (; i + 4 <= n; i += 4)
+    {
+        __m256i v = _mm256_loadu_si256((const __m256i *)(data + i));
+        best = _mm256_blendv_epi8(best, v, _mm256_cmpgt_epi64(best, v));
+    }
+
+    alignas(32) long long lanes[4];
+    _mm256_store_si256((__m256i *)lanes, best);
+
+    long long result = array_min<long long>(lanes, 4);
+    for (; i < n; ++i)
+        result = std::min(result, data[i]);
+
+    return result;
+}
+
+//products of two ints always fit 64 bits, a lane sum that leaves them sends the array through the scalar loop.
+//64 bit products have no vector overflow check, so long long storage uses the scalar template
+inline int array_dot(const int *a, const int *b, long long n)
+{
+    __m256i total = _mm256_setzero_si256();
+    __m256i overflow = _mm256_setzero_si256();
+
+    long long i = 0;
+    for (; i + 4 <= n; i += 4)
+    {
+        __m256i x = _mm256_cvtepi32_epi64(_mm_loadu_si128((const __m128i *)(a + i)));
+        __m256i y = _mm256_cvtepi32_epi64(_mm_loadu_si128((const __m128i *)(b + i)));
+        __m256i product = _mm256_mul_epi32(x, y);
+
+        __m256i result = _mm256_add_epi64(total, product);
+        overflow = _mm256_or_si256(overflow, kernel_add_overflow(total, product, result));
+        total = result;
+    }
+
+    if (kernel_any_sign(overflow))
+        return array_dot<int>(a, b, n);
+
+    __int128 result = kernel_horizontal_sum(total);
+    for (; i < n; ++i)
+        result += (long long)a[i] * b[i];
+
+    return kernel_narrow<int>(result);
+}
+
+#endif
+
+#endif
\ No newline at end of file
@@ -0,0 +1,35 @@
+#pragma once
+
+#ifndef ATOMICS_HEADER
+#define ATOMICS_HEADER
+
+#include <cstdint>
+#include <mutex>
+#include <type_traits>
+
+////ATOMIC UPDATES////
+//the built-ins behind ATOMIC ADD, MIN, MAX and CAS on one array element.
+//values that fit a machine word are updated in place with a compare and swap loop on the __atomic builtins,
+//so concurrent updates never take a lock; BASIC_BIGINT values own heap memory and fall back to striped locks
+
+//reads the slot, lets next compute the new value and retries until no other thread changed the slot in between.
+//next(current, desired) returns false to leave the slot as it is, then so does atomic_update
+template <class T, class F>
+bool atomic_update(T &slot, F next);
+
+template <class T>
+void atomic_add(T &slot, const T &v);
+
+template <class T>
+void atomic_min(T &slot, const T &v);
+
+template <class T>
+void atomic_max(T &slot, const T &v);
+
+//stores desired when the slot holds a value equal to expected, true when it did
+template <class T>
+bool atomic_cas(T &slot, const T &expected, const T &desired);
+
+#include "atomics.inl"
+
+#endif
\ No newline at end of file
@@ -0,0 +1,79 @@
+#ifndef ATOMICS_SOURCE
+#define ATOMICS_SOURCE
+
+//one lock per stripe of addresses, only used for values that can't be swapped as one word
+inline std::mutex &atomic_stripe(const void *slot)
+{
+    static std::mutex stripes[64];
+    return stripes[((std::uintptr_t)slot >> 4) % 64];
+}
+
+template <class T, class F>
+inline bool atomic_update(T &slot, F next)
+{
+    if constexpr (std::is_trivially_copyable<T>::value && sizeof(T) <= 8)
+    {
+        T current;
+        __atomic_load(&slot, &current, __ATOMIC_ACQUIRE);
+        T desired = current;
+
+        do
+        {
+            if (!next(current, desired))
+                return false;
+        } while (!__atomic_compare_exchange(&slot, &current, &desired, true, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE));
+
+        return true;
+    }
+    else
+    {
+        std::lock_guard<std::mutex> guard(atomic_stripe(&slot));
+
+        T desired = slot;
+        if (!next(slot, desired))
+            return false;
+
+        slot = desired;
+        return true;
+    }
+}
+
+//an overflowing ADD throws from inside the loop and leaves the element unchanged
+template <class T>
+inline void atomic_add(T &slot, const T &v)
+{
+    atomic_update(slot, [&v](const T &current, T &desired) {
+        desired = value_add(current, v);
+        return true;
+    });
+}
+
+template <class T>
+inline void atomic_min(T &slot, const T &v)
+{
+    atomic_update(slot, [&v](const T &current, T &desired) {
+        desired = v;
+        return v < current;
+    });
+}
+
+template <class T>
+inline void atomic_max(T &slot, const T &v)
+{
+    atomic_update(slot, [&v](const T &current, T &desired) {
+        desired = v;
+        return current < v;
+    });
+}
+
+//values are compared, not bits, so a NaN-boxed 2 still matches 2.0
+template <class T>
+inline bool atomic_cas(T &slot, const T &expected, const T &desired)
+{
+    return atomic_update(slot, [&expected, &desired](const T &current, T &next) {
+        next = desired;
+        return current == expected;
+    });
+}
+
+#endif
\ No newline at end of file
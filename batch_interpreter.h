@@ -0,0 +1,125 @@
+#pragma once
+
+#ifndef BATCH_INTERPRETER_HEADER
+#define BATCH_INTERPRETER_HEADER
+
+#include <istream>
+#include <ostream>
+
+#include "interpreter.h"
+
+#if defined(__AVX2__) || defined(__SSE2__)
+#include <immintrin.h>
+#endif
+
+//one value per input lane, lanes are stored contiguously so the arithmetic loops vectorize
+typedef std::vector<int> LaneVector;
+
+//masks hold -1 for lanes that take part in the current statement and 0 for the others
+typedef std::vector<int> LaneMask;
+
+////BATCH SYMBOL TABLE////
+class BatchScopedTable
+{
+public:
+    void dec_var(std::string identifier, std::size_t lanes);
+    void dec_arr(std::string identifier, std::size_t lanes);
+
+    LaneVector &lookup_var(const std::string &varname);
+    std::vector<std::vector<int>> &lookup_arr(const std::string &arr_name);
+
+    void addScope();
+    void removeScope();
+    BatchScopedTable();
+
+private:
+    struct Scope
+    {
+        std::unordered_map<std::string, LaneVector> vars;
+        //arrays are sized per lane because every lane can declare a different length
+        std::unordered_map<std::string, std::vector<std::vector<int>>> arrays;
+    };
+
+    std::vector<Scope> scopes;
+};
+
+////BATCH INTERPRETER////
+//runs one program over many independent input streams in lockstep;
+//divergent IF/WHILE conditions and GOTOs are handled by masking lanes out
+class BatchInterpreter : public Visitor
+{
+private:
+    Deleter deleter;
+    DataExtractor extractor;
+
+    AST_Node *tree;
+
+    std::size_t lanes;
+
+    std::vector<std::istream *> inputs;
+    std::vector<std::ostream *> outputs;
+
+    LaneVector value; //used to evaluate expressions, one result per lane
+    LaneMask mask;    //lanes that are currently executing
+
+    //index of the label every lane is skipping to, -1 when the lane is running
+    std::vector<int> skip_label;
+    std::unordered_map<std::string, int> label_ids;
+
+    //mask of the innermost block at the moment it was entered, labels can only resume those lanes
+    LaneMask block_mask;
+
+    BatchScopedTable nested_scopes;
+
+    bool any_active(const LaneMask &m) const;
+    void restore_mask(const LaneMask &saved);
+    void condition_mask(const LaneVector &cond, const LaneMask &base, LaneMask &result, bool negate) const;
+    int read_lane(std::size_t lane);
+    AST_Node *single_index(const std::vector<AST_Node *> &indices) const;
+    void fail_lane(std::size_t lane, const char *message);
+
+public:
+    BatchInterpreter(AST_Node *t, std::vector<std::istream *> in, std::vector<std::ostream *> out);
+
+    void visit(GoTo *ast);
+    void visit(Label *ast);
+    void visit(BlockCode *ast);
+    void visit(IfElse *ast);
+    void visit(While *ast);
+    void visit(VarDecl *ast);
+    void visit(ArrDecl *ast);
+    void visit(VarAssign *ast);
+    void visit(ArrAssign *ast);
+    void visit(ReadVar *ast);
+    void visit(ReadArr *ast);
+    void visit(Print *ast);
+    void visit(Bin_OP *ast);
+    void visit(Num *ast);
+    void visit(Var *ast);
+    void visit(Array *ast);
+    void visit(Un_OP *ast);
+    void visit(ArrReduce *ast);
+    void visit(ArrDot *ast);
+    void visit(ArrFill *ast);
+    void visit(ArrCopy *ast);
+    void visit(ArrSort *ast);
+    void visit(ArrSearch *ast);
+    void visit(ArrFile *ast);
+    void visit(ForEach *ast);
+    void visit(ParallelFor *ast);
+    void visit(Reduce *ast);
+    void visit(AtomicOp *ast);
+    void visit(Spawn *ast);
+    void visit(Join *ast);
+    void visit(Yield *ast);
+    void visit(ChanDecl *ast);
+    void visit(Send *ast);
+    void visit(Recv *ast);
+    void visit(NO_OP *ast);
+
+    void interpret_fullprogram();
+};
+
+#include "batch_interpreter.inl"
+
+#endif
\ No newline at end of file
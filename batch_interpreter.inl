@@ -0,0 +1,1120 @@
+#ifndef BATCH_INTERPRETER_SOURCE
+#define BATCH_INTERPRETER_SOURCE
+
+//LANE KERNELS
+//every operation has an AVX2 body (8 lanes), an SSE2 body (4 lanes) and a scalar body for the tail.
+//arithmetic wraps around like the hardware does instead of relying on signed overflow.
+
+struct LaneAdd
+{
+#if defined(__AVX2__)
+    static __m256i avx(__m256i x, __m256i y) { return _mm256_add_epi32(x, y); }
+#endif
+#if defined(__SSE2__)
+    static __m128i sse(__m128i x, __m128i y) { return _mm_add_epi32(x, y); }
+#endif
+    static int scalar(int x, int y) { return (int)((unsigned)x + (unsigned)y); }
+};
+
+struct LaneSub
+{
+#if defined(__AVX2__)
+    static __m256i avx(__m256i x, __m256i y) { return _mm256_sub_epi32(x, y); }
+#endif
+#if defined(__SSE2__)
+    static __m128i sse(__m128i x, __m128i y) { return _mm_sub_epi32(x, y); }
+#endif
+    static int scalar(int x, int y) { return (int)((unsigned)x - (unsigned)y); }
+};
+
+struct LaneMul
+{
+#if defined(__AVX2__)
+    static __m256i avx(__m256i x, __m256i y) { return _mm256_mullo_epi32(x, y); }
+#endif
+#if defined(__SSE4_1__)
+    static __m128i sse(__m128i x, __m128i y) { return _mm_mullo_epi32(x, y); }
+#elif defined(__SSE2__)
+    //SSE2 only multiplies the even 32 bit lanes, so the odd ones are shifted down and the halves merged
+    static __m128i sse(__m128i x, __m128i y)
+    {
+        __m128i even = _mm_mul_epu32(x, y);
+        __m128i odd = _mm_mul_epu32(_mm_srli_epi64(x, 32), _mm_srli_epi64(y, 32));
+        return _mm_unpacklo_epi32(_mm_shuffle_epi32(even, _MM_SHUFFLE(0, 0, 2, 0)),
+                                  _mm_shuffle_epi32(odd, _MM_SHUFFLE(0, 0, 2, 0)));
+    }
+#endif
+    static int scalar(int x, int y) { return (int)((unsigned)x * (unsigned)y); }
+};
+
+//comparisons produce 1 or 0 just like the scalar interpreter
+struct LaneEq
+{
+#if defined(__AVX2__)
+    static __m256i avx(__m256i x, __m256i y) { return _mm256_and_si256(_mm256_cmpeq_epi32(x, y), _mm256_set1_epi32(1)); }
+#endif
+#if defined(__SSE2__)
+    static __m128i sse(__m128i x, __m128i y) { return _mm_and_si128(_mm_cmpeq_epi32(x, y), _mm_set1_epi32(1)); }
+#endif
+    static int scalar(int x, int y) { return x == y; }
+};
+
+struct LaneNeq
+{
+#if defined(__AVX2__)
+    static __m256i avx(__m256i x, __m256i y) { return _mm256_andnot_si256(_mm256_cmpeq_epi32(x, y), _mm256_set1_epi32(1)); }
+#endif
+#if defined(__SSE2__)
+    static __m128i sse(__m128i x, __m128i y) { return _mm_andnot_si128(_mm_cmpeq_epi32(x, y), _mm_set1_epi32(1)); }
+#endif
+    static int scalar(int x, int y) { return x != y; }
+};
+
+struct LaneLess
+{
+#if defined(__AVX2__)
+    static __m256i avx(__m256i x, __m256i y) { return _mm256_and_si256(_mm256_cmpgt_epi32(y, x), _mm256_set1_epi32(1)); }
+#endif
+#if defined(__SSE2__)
+    static __m128i sse(__m128i x, __m128i y) { return _mm_and_si128(_mm_cmplt_epi32(x, y), _mm_set1_epi32(1)); }
+#endif
+    static int scalar(int x, int y) { return x < y; }
+};
+
+struct LaneLessEq
+{
+#if defined(__AVX2__)
+    static __m256i avx(__m256i x, __m256i y) { return _mm256_andnot_si256(_mm256_cmpgt_epi32(x, y), _mm256_set1_epi32(1)); }
+#endif
+#if defined(__SSE2__)
+    static __m128i sse(__m128i x, __m128i y) { return _mm_andnot_si128(_mm_cmpgt_epi32(x, y), _mm_set1_epi32(1)); }
+#endif
+    static int scalar(int x, int y) { return x <= y; }
+};
+
+struct LaneMore
+{
+#if defined(__AVX2__)
+    static __m256i avx(__m256i x, __m256i y) { return _mm256_and_si256(_mm256_cmpgt_epi32(x, y), _mm256_set1_epi32(1)); }
+#endif
+#if defined(__SSE2__)
+    static __m128i sse(__m128i x, __m128i y) { return _mm_and_si128(_mm_cmpgt_epi32(x, y), _mm_set1_epi32(1)); }
+#endif
+    static int scalar(int x, int y) { return x > y; }
+};
+
+struct LaneMoreEq
+{
+#if defined(__AVX2__)
+    static __m256i avx(__m256i x, __m256i y) { return _mm256_andnot_si256(_mm256_cmpgt_epi32(y, x), _mm256_set1_epi32(1)); }
+#endif
+#if defined(__SSE2__)
+    static __m128i sse(__m128i x, __m128i y) { return _mm_andnot_si128(_mm_cmplt_epi32(x, y), _mm_set1_epi32(1)); }
+#endif
+    static int scalar(int x, int y) { return x >= y; }
+};
+
+struct LaneAnd
+{
+#if defined(__AVX2__)
+    static __m256i avx(__m256i x, __m256i y)
+    {
+        __m256i zero = _mm256_setzero_si256();
+        __m256i any_zero = _mm256_or_si256(_mm256_cmpeq_epi32(x, zero), _mm256_cmpeq_epi32(y, zero));
+        return _mm256_andnot_si256(any_zero, _mm256_set1_epi32(1));
+    }
+#endif
+#if defined(__SSE2__)
+    static __m128i sse(__m128i x, __m128i y)
+    {
+        __m128i zero = _mm_setzero_si128();
+        __m128i any_zero = _mm_or_si128(_mm_cmpeq_epi32(x, zero), _mm_cmpeq_epi32(y, zero));
+        return _mm_andnot_si128(any_zero, _mm_set1_epi32(1));
+    }
+#endif
+    static int scalar(int x, int y) { return x && y; }
+};
+
+struct LaneOr
+{
+#if defined(__AVX2__)
+    static __m256i avx(__m256i x, __m256i y)
+    {
+        __m256i zero = _mm256_setzero_si256();
+        __m256i both_zero = _mm256_and_si256(_mm256_cmpeq_epi32(x, zero), _mm256_cmpeq_epi32(y, zero));
+        return _mm256_andnot_si256(both_zero, _mm256_set1_epi32(1));
+    }
+#endif
+#if defined(__SSE2__)
+    static __m128i sse(__m128i x, __m128i y)
+    {
+        __m128i zero = _mm_setzero_si128();
+        __m128i both_zero = _mm_and_si128(_mm_cmpeq_epi32(x, zero), _mm_cmpeq_epi32(y, zero));
+        return _mm_andnot_si128(both_zero, _mm_set1_epi32(1));
+    }
+#endif
+    static int scalar(int x, int y) { return x || y; }
+};
+
+template <class Op>
+inline void lanes_apply(int *dst, const int *a, const int *b, std::size_t n)
+{
+    std::size_t i = 0;
+#if defined(__AVX2__)
+    for (; i + 8 <= n; i += 8)
+    {
+        __m256i x = _mm256_loadu_si256((const __m256i *)(a + i));
+        __m256i y = _mm256_loadu_si256((const __m256i *)(b + i));
+        _mm256_storeu_si256((__m256i *)(dst + i), Op::avx(x, y));
+    }
+#endif
+#if defined(__SSE2__)
+    for (; i + 4 <= n; i += 4)
+    {
+        __m128i x = _mm_loadu_si128((const __m128i *)(a + i));
+        __m128i y = _mm_loadu_si128((const __m128i *)(b + i));
+        _mm_storeu_si128((__m128i *)(dst + i), Op::sse(x, y));
+    }
+#endif
+    for (; i < n; ++i)
+        dst[i] = Op::scalar(a[i], b[i]);
+}
+
+//dst takes the value from src in every lane where the mask is set
+inline void lanes_blend(int *dst, const int *src, const int *m, std::size_t n)
+{
+    std::size_t i = 0;
+#if defined(__AVX2__)
+    for (; i + 8 <= n; i += 8)
+    {
+        __m256i d = _mm256_loadu_si256((const __m256i *)(dst + i));
+        __m256i s = _mm256_loadu_si256((const __m256i *)(src + i));
+        __m256i k = _mm256_loadu_si256((const __m256i *)(m + i));
+        _mm256_storeu_si256((__m256i *)(dst + i), _mm256_blendv_epi8(d, s, k));
+    }
+#endif
+    for (; i < n; ++i)
+        dst[i] = (src[i] & m[i]) | (dst[i] & ~m[i]);
+}
+
+//BATCH SYMBOL TABLE
+
+inline BatchScopedTable::BatchScopedTable()
+{
+    scopes.push_back(Scope());
+}
+
+inline void BatchScopedTable::dec_var(std::string identifier, std::size_t lanes)
+{
+    scopes.back().vars.insert({identifier, LaneVector(lanes, 0)});
+}
+
+inline void BatchScopedTable::dec_arr(std::string identifier, std::size_t lanes)
+{
+    scopes.back().arrays.insert({identifier, std::vector<std::vector<int>>(lanes)});
+}
+
+inline LaneVector &BatchScopedTable::lookup_var(const std::string &varname)
+{
+    for (int i = 0; i < scopes.size(); ++i)
+    {
+        std::unordered_map<std::string, LaneVector>::iterator got = scopes[i].vars.find(varname);
+        if (got != scopes[i].vars.end())
+            return got->second;
+    }
+
+    throw std::invalid_argument("variable cannot be found");
+}
+
+inline std::vector<std::vector<int>> &BatchScopedTable::lookup_arr(const std::string &arr_name)
+{
+    for (int i = 0; i < scopes.size(); ++i)
+    {
+        std::unordered_map<std::string, std::vector<std::vector<int>>>::iterator got = scopes[i].arrays.find(arr_name);
+        if (got != scopes[i].arrays.end())
+            return got->second;
+    }
+
+    throw std::invalid_argument("cannot find the value at given index or array is not declared");
+}
+
+inline void BatchScopedTable::addScope()
+{
+    scopes.push_back(Scope());
+}
+
+inline void BatchScopedTable::removeScope()
+{
+    scopes.pop_back();
+}
+
+//BATCH INTERPRETER
+
+inline BatchInterpreter::BatchInterpreter(AST_Node *t, std::vector<std::istream *> in, std::vector<std::ostream *> out)
+    : tree(t), lanes(in.size()), inputs(in), outputs(out)
+{
+    if (inputs.size() != outputs.size())
+        throw std::invalid_argument("every lane needs one input and one output stream");
+
+    BeforeInterpret b;
+    tree->accept(b);
+
+    int id = 0;
+    for (std::unordered_set<std::string>::const_iterator it = b.labels.begin(); it != b.labels.end(); ++it)
+        label_ids.insert({*it, id++});
+
+    value.assign(lanes, 0);
+    mask.assign(lanes, -1);
+    block_mask = mask;
+    skip_label.assign(lanes, -1);
+}
+
+inline bool BatchInterpreter::any_active(const LaneMask &m) const
+{
+    for (std::size_t i = 0; i < lanes; ++i)
+        if (m[i])
+            return true;
+
+    return false;
+}
+
+//lanes that started skipping to a label or failed inside a nested block stay switched off
+inline void BatchInterpreter::restore_mask(const LaneMask &saved)
+{
+    for (std::size_t i = 0; i < lanes; ++i)
+        mask[i] = saved[i] & -(int)(skip_label[i] == -1);
+}
+
+inline void BatchInterpreter::condition_mask(const LaneVector &cond, const LaneMask &base, LaneMask &result, bool negate) const
+{
+    result.resize(lanes);
+    for (std::size_t i = 0; i < lanes; ++i)
+        result[i] = base[i] & -(int)((cond[i] != 0) != negate);
+}
+
+//lanes keep one flat vector per array, so only one dimensional arrays run in batch mode
+inline AST_Node *BatchInterpreter::single_index(const std::vector<AST_Node *> &indices) const
+{
+    if (indices.size() != 1)
+        throw std::invalid_argument("batch mode supports only one dimensional arrays");
+
+    return indices[0];
+}
+
+//a lane that hits a runtime error reports it on its own output and stops, the other lanes continue
+static const int BATCH_LANE_FAILED = -2;
+
+inline void BatchInterpreter::fail_lane(std::size_t lane, const char *message)
+{
+    *outputs[lane] << "error: " << message << "\n";
+    skip_label[lane] = BATCH_LANE_FAILED;
+    mask[lane] = 0;
+}
+
+inline int BatchInterpreter::read_lane(std::size_t lane)
+{
+    std::string input;
+    if (!getline(*inputs[lane], input))
+        throw std::invalid_argument("no more input");
+
+    //fast path for plain integer literals, everything else goes through the expression parser
+    std::size_t pos = input.find_first_not_of(" \t\r");
+    std::size_t end = input.find_last_not_of(" \t\r");
+    if (pos != std::string::npos)
+    {
+        bool negative = input[pos] == '-';
+        std::size_t digits = negative ? pos + 1 : pos;
+        if (digits <= end && input.find_first_not_of("0123456789", digits) > end)
+        {
+            //the digits are taken with the sign, so the smallest int fits and anything outside an int is an error
+            int result = 0;
+            for (std::size_t i = digits; i <= end; ++i)
+                if (__builtin_mul_overflow(result, 10, &result) ||
+                    (negative ? __builtin_sub_overflow(result, input[i] - '0', &result)
+                              : __builtin_add_overflow(result, input[i] - '0', &result)))
+                    throw std::overflow_error("integer literal does not fit the 32 bit batch lanes");
+            return result;
+        }
+    }
+
+    Lexer inputLex(input);
+    Parser inputParse(inputLex);
+    AST_Node *expr = inputParse.Expression();
+
+    LaneMask saved_mask = mask;
+    std::fill(mask.begin(), mask.end(), 0);
+    mask[lane] = -1;
+
+    try
+    {
+        expr->accept(*this);
+    }
+    catch (...)
+    {
+        mask = saved_mask;
+        expr->accept(deleter);
+        throw;
+    }
+
+    mask = saved_mask;
+    expr->accept(deleter);
+
+    return value[lane];
+}
+
+inline void BatchInterpreter::visit(GoTo *ast)
+{
+    ast->accept(extractor);
+    std::string goto_label = extractor.type.text_data;
+
+    std::unordered_map<std::string, int>::const_iterator got = label_ids.find(goto_label);
+    if (got == label_ids.end())
+        throw std::invalid_argument("no such label in program!");
+
+    for (std::size_t i = 0; i < lanes; ++i)
+    {
+        if (mask[i])
+        {
+            skip_label[i] = got->second;
+            mask[i] = 0;
+        }
+    }
+}
+
+inline void BatchInterpreter::visit(Label *ast)
+{
+    ast->accept(extractor);
+
+    std::unordered_map<std::string, int>::const_iterator got = label_ids.find(extractor.type.text_data);
+    if (got == label_ids.end())
+        return;
+
+    for (std::size_t i = 0; i < lanes; ++i)
+    {
+        if (block_mask[i] && skip_label[i] == got->second)
+        {
+            skip_label[i] = -1;
+            mask[i] = -1;
+        }
+    }
+}
+
+inline void BatchInterpreter::visit(BlockCode *ast)
+{
+    //no lane entered the block, so none of them can be resumed by a label inside it either
+    if (!any_active(mask))
+        return;
+
+    LaneMask outer_block = block_mask;
+    block_mask = mask;
+
+    for (int i = 0; i < ast->statements.size(); ++i)
+    {
+        ast->statements[i]->accept(*this);
+    }
+
+    block_mask = outer_block;
+}
+
+inline void BatchInterpreter::visit(IfElse *ast)
+{
+    LaneMask saved = mask;
+
+    ast->expr->accept(*this);
+    LaneVector cond = value;
+
+    nested_scopes.addScope();
+
+    condition_mask(cond, saved, mask, false);
+    ast->bCode1->accept(*this);
+    LaneMask after_then = mask;
+
+    condition_mask(cond, saved, mask, true);
+    ast->bCode2->accept(*this);
+
+    for (std::size_t i = 0; i < lanes; ++i)
+        mask[i] |= after_then[i];
+
+    nested_scopes.removeScope();
+}
+
+inline void BatchInterpreter::visit(While *ast)
+{
+    LaneMask saved = mask;
+
+    ast->expr->accept(*this);
+    condition_mask(value, saved, mask, false);
+
+    while (any_active(mask))
+    {
+        nested_scopes.addScope();
+
+        ast->bCode->accept(*this);
+
+        //lanes that jumped out of the body are already switched off in the mask
+        LaneMask still_running = mask;
+        ast->expr->accept(*this);
+        condition_mask(value, still_running, mask, false);
+
+        nested_scopes.removeScope();
+    }
+
+    restore_mask(saved);
+}
+
+//the iterations are independent, so running them in order on every lane is one of the allowed schedules
+inline void BatchInterpreter::visit(ParallelFor *ast)
+{
+    LaneMask saved = mask;
+
+    ast->from->accept(*this);
+    LaneVector index = value;
+    ast->to->accept(*this);
+    LaneVector last = value;
+
+    for (std::size_t i = 0; i < lanes; ++i)
+        mask[i] &= -(int)(index[i] <= last[i]);
+
+    while (any_active(mask))
+    {
+        nested_scopes.addScope();
+        nested_scopes.dec_var(ast->var.text_data, lanes);
+
+        LaneVector &var = nested_scopes.lookup_var(ast->var.text_data);
+        lanes_blend(var.data(), index.data(), mask.data(), lanes);
+
+        ast->bCode->accept(*this);
+
+        nested_scopes.removeScope();
+
+        //checked before the increment so a loop ending at the largest int does not overflow
+        for (std::size_t i = 0; i < lanes; ++i)
+        {
+            mask[i] &= -(int)(index[i] < last[i]);
+            index[i] += mask[i] & 1;
+        }
+    }
+
+    restore_mask(saved);
+}
+
+//folded in order on every lane; SUM wraps like the other batch arithmetic
+inline void BatchInterpreter::visit(Reduce *ast)
+{
+    LaneMask saved = mask;
+
+    ast->from->accept(*this);
+    LaneVector index = value;
+    ast->to->accept(*this);
+    LaneVector last = value;
+
+    for (std::size_t i = 0; i < lanes; ++i)
+        mask[i] &= -(int)(index[i] <= last[i]);
+
+    while (any_active(mask))
+    {
+        nested_scopes.addScope();
+        nested_scopes.dec_var(ast->var.text_data, lanes);
+
+        LaneVector &var = nested_scopes.lookup_var(ast->var.text_data);
+        lanes_blend(var.data(), index.data(), mask.data(), lanes);
+
+        ast->expr->accept(*this);
+
+        nested_scopes.removeScope();
+
+        LaneVector &target = nested_scopes.lookup_var(ast->target.text_data);
+        if (ast->op.t == Token::SUM)
+        {
+            LaneVector sum(lanes);
+            lanes_apply<LaneAdd>(sum.data(), target.data(), value.data(), lanes);
+            lanes_blend(target.data(), sum.data(), mask.data(), lanes);
+        }
+        else
+        {
+            for (std::size_t i = 0; i < lanes; ++i)
+            {
+                if (mask[i] && (ast->op.t == Token::MIN ? value[i] < target[i] : value[i] > target[i]))
+                    target[i] = value[i];
+            }
+        }
+
+        for (std::size_t i = 0; i < lanes; ++i)
+        {
+            mask[i] &= -(int)(index[i] < last[i]);
+            index[i] += mask[i] & 1;
+        }
+    }
+
+    restore_mask(saved);
+}
+
+inline void BatchInterpreter::visit(VarDecl *ast)
+{
+    ast->var->accept(extractor);
+    std::string varname = extractor.type.text_data;
+
+    nested_scopes.dec_var(varname, lanes);
+}
+
+inline void BatchInterpreter::visit(ArrDecl *ast)
+{
+    if (ast->storage.t == Token::MAP)
+        throw std::invalid_argument("batch mode does not support MAP arrays");
+    if (ast->storage.t == Token::SPARSE)
+        throw std::invalid_argument("batch mode does not support SPARSE arrays");
+
+    ast->arr->accept(extractor);
+    std::string arrname = extractor.type.text_data;
+
+    single_index(*extractor.indices)->accept(*this);
+
+    nested_scopes.dec_arr(arrname, lanes);
+    std::vector<std::vector<int>> &arr = nested_scopes.lookup_arr(arrname);
+
+    for (std::size_t i = 0; i < lanes; ++i)
+    {
+        if (!mask[i])
+            continue;
+
+        if (value[i] < 0)
+        {
+            *outputs[i] << "error: invalid array size\n";
+            skip_label[i] = BATCH_LANE_FAILED;
+            mask[i] = 0;
+            continue;
+        }
+
+        arr[i].assign(value[i], 0);
+    }
+}
+
+inline void BatchInterpreter::visit(VarAssign *ast)
+{
+    ast->var->accept(extractor);
+    std::string varname = extractor.type.text_data;
+
+    ast->expr->accept(*this);
+
+    LaneVector &var = nested_scopes.lookup_var(varname);
+    lanes_blend(var.data(), value.data(), mask.data(), lanes);
+}
+
+inline void BatchInterpreter::visit(ArrAssign *ast)
+{
+    ast->arr->accept(extractor);
+    std::string arrname = extractor.type.text_data;
+    AST_Node *index_node = single_index(*extractor.indices);
+
+    ast->expr->accept(*this);
+    LaneVector data = value;
+
+    index_node->accept(*this);
+
+    std::vector<std::vector<int>> &arr = nested_scopes.lookup_arr(arrname);
+
+    for (std::size_t i = 0; i < lanes; ++i)
+    {
+        if (!mask[i])
+            continue;
+
+        if (value[i] < 0 || value[i] >= arr[i].size())
+        {
+            *outputs[i] << "error: cannot find the value at given index or array is not declared\n";
+            skip_label[i] = BATCH_LANE_FAILED;
+            mask[i] = 0;
+            continue;
+        }
+
+        arr[i][value[i]] = data[i];
+    }
+}
+
+inline void BatchInterpreter::visit(ReadVar *ast)
+{
+    ast->var->accept(extractor);
+    std::string varname = extractor.type.text_data;
+
+    LaneVector input(lanes, 0);
+    for (std::size_t i = 0; i < lanes; ++i)
+    {
+        if (!mask[i])
+            continue;
+
+        try
+        {
+            input[i] = read_lane(i);
+        }
+        catch (const std::exception &e)
+        {
+            *outputs[i] << "error: " << e.what() << "\n";
+            skip_label[i] = BATCH_LANE_FAILED;
+            mask[i] = 0;
+        }
+    }
+
+    LaneVector &var = nested_scopes.lookup_var(varname);
+    lanes_blend(var.data(), input.data(), mask.data(), lanes);
+}
+
+inline void BatchInterpreter::visit(ReadArr *ast)
+{
+    LaneVector input(lanes, 0);
+    for (std::size_t i = 0; i < lanes; ++i)
+    {
+        if (!mask[i])
+            continue;
+
+        try
+        {
+            input[i] = read_lane(i);
+        }
+        catch (const std::exception &e)
+        {
+            *outputs[i] << "error: " << e.what() << "\n";
+            skip_label[i] = BATCH_LANE_FAILED;
+            mask[i] = 0;
+        }
+    }
+
+    ast->arr->accept(extractor);
+    std::string arrname = extractor.type.text_data;
+
+    single_index(*extractor.indices)->accept(*this);
+
+    std::vector<std::vector<int>> &arr = nested_scopes.lookup_arr(arrname);
+
+    for (std::size_t i = 0; i < lanes; ++i)
+    {
+        if (!mask[i])
+            continue;
+
+        if (value[i] < 0 || value[i] >= arr[i].size())
+        {
+            *outputs[i] << "error: cannot find the value at given index or array is not declared\n";
+            skip_label[i] = BATCH_LANE_FAILED;
+            mask[i] = 0;
+            continue;
+        }
+
+        arr[i][value[i]] = input[i];
+    }
+}
+
+inline void BatchInterpreter::visit(Print *ast)
+{
+    ast->expr_to_print->accept(*this);
+
+    for (std::size_t i = 0; i < lanes; ++i)
+    {
+        if (mask[i])
+            *outputs[i] << value[i] << '\n';
+    }
+}
+
+inline void BatchInterpreter::visit(Bin_OP *ast)
+{
+    ast->left->accept(*this);
+    LaneVector v1;
+    v1.swap(value);
+    ast->right->accept(*this);
+    LaneVector v2;
+    v2.swap(value);
+
+    value.resize(lanes);
+
+    switch (ast->op.t)
+    {
+    case Token::PLUS:
+        lanes_apply<LaneAdd>(value.data(), v1.data(), v2.data(), lanes);
+        break;
+    case Token::MINUS:
+        lanes_apply<LaneSub>(value.data(), v1.data(), v2.data(), lanes);
+        break;
+    case Token::MUL:
+        lanes_apply<LaneMul>(value.data(), v1.data(), v2.data(), lanes);
+        break;
+    case Token::DIV:
+    case Token::MOD:
+        //there is no integer division in SSE/AVX, and only the active lanes may trip the zero check
+        for (std::size_t i = 0; i < lanes; ++i)
+        {
+            if (!mask[i])
+            {
+                value[i] = 0;
+                continue;
+            }
+
+            if (v2[i] == 0)
+            {
+                *outputs[i] << "error: cant divide by zero!\n";
+                skip_label[i] = BATCH_LANE_FAILED;
+                mask[i] = 0;
+                value[i] = 0;
+                continue;
+            }
+
+            //INT_MIN / -1 traps on x86, it wraps to INT_MIN like the other lanes do
+            if (v2[i] == -1)
+                value[i] = ast->op.t == Token::DIV ? (int)(0u - (unsigned)v1[i]) : 0;
+            else
+                value[i] = ast->op.t == Token::DIV ? v1[i] / v2[i] : v1[i] % v2[i];
+        }
+        break;
+    case Token::EQ:
+        lanes_apply<LaneEq>(value.data(), v1.data(), v2.data(), lanes);
+        break;
+    case Token::NEQ:
+        lanes_apply<LaneNeq>(value.data(), v1.data(), v2.data(), lanes);
+        break;
+    case Token::LESS:
+        lanes_apply<LaneLess>(value.data(), v1.data(), v2.data(), lanes);
+        break;
+    case Token::LESSEQ:
+        lanes_apply<LaneLessEq>(value.data(), v1.data(), v2.data(), lanes);
+        break;
+    case Token::MORE:
+        lanes_apply<LaneMore>(value.data(), v1.data(), v2.data(), lanes);
+        break;
+    case Token::MOREEQ:
+        lanes_apply<LaneMoreEq>(value.data(), v1.data(), v2.data(), lanes);
+        break;
+    case Token::OR:
+        lanes_apply<LaneOr>(value.data(), v1.data(), v2.data(), lanes);
+        break;
+    case Token::AND:
+        lanes_apply<LaneAnd>(value.data(), v1.data(), v2.data(), lanes);
+        break;
+    }
+}
+
+inline void BatchInterpreter::visit(Num *ast)
+{
+    //the lanes stay 32 bit even in BASIC_INT64 and BASIC_BIGINT builds, that is what keeps 8 of them in one AVX2 register
+    long long literal;
+    if (!value_fits_long(ast->token.value, literal) || literal != (int)literal)
+        throw std::overflow_error("integer literal does not fit the 32 bit batch lanes");
+
+    value.assign(lanes, (int)literal);
+}
+
+inline void BatchInterpreter::visit(Var *ast)
+{
+    value = nested_scopes.lookup_var(ast->token.text_data);
+}
+
+inline void BatchInterpreter::visit(Array *ast)
+{
+    std::vector<std::vector<int>> &arr = nested_scopes.lookup_arr(ast->token.text_data);
+
+    single_index(ast->indices)->accept(*this);
+
+    for (std::size_t i = 0; i < lanes; ++i)
+    {
+        if (!mask[i])
+        {
+            value[i] = 0;
+            continue;
+        }
+
+        if (value[i] < 0 || value[i] >= arr[i].size())
+        {
+            *outputs[i] << "error: cannot find the value at given index or array is not declared\n";
+            skip_label[i] = BATCH_LANE_FAILED;
+            mask[i] = 0;
+            value[i] = 0;
+            continue;
+        }
+
+        value[i] = arr[i][value[i]];
+    }
+}
+
+inline void BatchInterpreter::visit(Un_OP *ast)
+{
+    ast->expr->accept(*this);
+
+    switch (ast->op.t)
+    {
+    case Token::NOT:
+        for (std::size_t i = 0; i < lanes; ++i)
+            value[i] = !value[i];
+        break;
+    case Token::MINUS:
+        for (std::size_t i = 0; i < lanes; ++i)
+            value[i] = (int)(0u - (unsigned)value[i]);
+        break;
+    }
+}
+
+//the intrinsics run the array kernels once per lane on that lane's own array
+
+inline void BatchInterpreter::visit(ArrReduce *ast)
+{
+    std::vector<std::vector<int>> &arr = nested_scopes.lookup_arr(ast->arr.text_data);
+
+    ast->count->accept(*this);
+
+    for (std::size_t i = 0; i < lanes; ++i)
+    {
+        if (!mask[i])
+        {
+            value[i] = 0;
+            continue;
+        }
+
+        if (value[i] < 0 || value[i] > arr[i].size() || (ast->op.t != Token::SUM && value[i] == 0))
+        {
+            fail_lane(i, "element count is outside the array");
+            value[i] = 0;
+            continue;
+        }
+
+        try
+        {
+            if (ast->op.t == Token::SUM)
+                value[i] = array_sum(arr[i].data(), value[i]);
+            else if (ast->op.t == Token::MAX)
+                value[i] = array_max(arr[i].data(), value[i]);
+            else
+                value[i] = array_min(arr[i].data(), value[i]);
+        }
+        catch (const std::exception &e)
+        {
+            fail_lane(i, e.what());
+            value[i] = 0;
+        }
+    }
+}
+
+inline void BatchInterpreter::visit(ArrDot *ast)
+{
+    std::vector<std::vector<int>> &left = nested_scopes.lookup_arr(ast->left.text_data);
+    std::vector<std::vector<int>> &right = nested_scopes.lookup_arr(ast->right.text_data);
+
+    ast->count->accept(*this);
+
+    for (std::size_t i = 0; i < lanes; ++i)
+    {
+        if (!mask[i])
+        {
+            value[i] = 0;
+            continue;
+        }
+
+        if (value[i] < 0 || value[i] > left[i].size() || value[i] > right[i].size())
+        {
+            fail_lane(i, "element count is outside the array");
+            value[i] = 0;
+            continue;
+        }
+
+        try
+        {
+            value[i] = array_dot(left[i].data(), right[i].data(), value[i]);
+        }
+        catch (const std::exception &e)
+        {
+            fail_lane(i, e.what());
+            value[i] = 0;
+        }
+    }
+}
+
+inline void BatchInterpreter::visit(ArrFill *ast)
+{
+    ast->expr->accept(*this);
+
+    std::vector<std::vector<int>> &arr = nested_scopes.lookup_arr(ast->arr.text_data);
+
+    for (std::size_t i = 0; i < lanes; ++i)
+    {
+        if (mask[i])
+            array_fill(arr[i].data(), (long long)arr[i].size(), value[i]);
+    }
+}
+
+inline void BatchInterpreter::visit(ArrCopy *ast)
+{
+    std::vector<std::vector<int>> &from = nested_scopes.lookup_arr(ast->from.text_data);
+    std::vector<std::vector<int>> &to = nested_scopes.lookup_arr(ast->to.text_data);
+
+    for (std::size_t i = 0; i < lanes; ++i)
+    {
+        if (!mask[i])
+            continue;
+
+        if (to[i].size() < from[i].size())
+        {
+            fail_lane(i, "COPY target is smaller than the source");
+            continue;
+        }
+
+        array_copy(from[i].data(), (long long)from[i].size(), to[i].data());
+    }
+}
+
+//lanes are sorted one after the other, each one still uses the whole pool above the threshold
+inline void BatchInterpreter::visit(ArrSort *ast)
+{
+    std::vector<std::vector<int>> &arr = nested_scopes.lookup_arr(ast->arr.text_data);
+
+    ast->count->accept(*this);
+
+    for (std::size_t i = 0; i < lanes; ++i)
+    {
+        if (!mask[i])
+            continue;
+
+        if (value[i] < 0 || value[i] > arr[i].size())
+        {
+            fail_lane(i, "element count is outside the array");
+            continue;
+        }
+
+        parallel_sort(arr[i].data(), value[i], ThreadPool::shared());
+    }
+}
+
+inline void BatchInterpreter::visit(ArrFile *ast)
+{
+    throw std::invalid_argument("batch mode does not support LOAD and STORE");
+}
+
+inline void BatchInterpreter::visit(ForEach *ast)
+{
+    throw std::invalid_argument("batch mode does not support FOR IN loops");
+}
+
+inline void BatchInterpreter::visit(ArrSearch *ast)
+{
+    std::vector<std::vector<int>> &arr = nested_scopes.lookup_arr(ast->arr.text_data);
+
+    ast->count->accept(*this);
+    LaneVector count = value;
+
+    ast->key->accept(*this);
+
+    for (std::size_t i = 0; i < lanes; ++i)
+    {
+        if (!mask[i])
+        {
+            value[i] = 0;
+            continue;
+        }
+
+        if (count[i] < 0 || count[i] > arr[i].size())
+        {
+            fail_lane(i, "element count is outside the array");
+            value[i] = 0;
+            continue;
+        }
+
+        value[i] = sorted_search(arr[i].data(), count[i], value[i]);
+    }
+}
+
+//the lanes run on one thread, so the update is a plain one; ADD wraps like the other batch arithmetic
+inline void BatchInterpreter::visit(AtomicOp *ast)
+{
+    ast->arr->accept(extractor);
+    std::string arrname = extractor.type.text_data;
+    AST_Node *index_node = single_index(*extractor.indices);
+
+    ast->expr->accept(*this);
+    LaneVector operand = value;
+
+    LaneVector desired(lanes, 0);
+    if (ast->desired)
+    {
+        ast->desired->accept(*this);
+        desired = value;
+    }
+
+    index_node->accept(*this);
+
+    std::vector<std::vector<int>> &arr = nested_scopes.lookup_arr(arrname);
+    LaneVector ok(lanes, 0);
+
+    for (std::size_t i = 0; i < lanes; ++i)
+    {
+        if (!mask[i])
+            continue;
+
+        if (value[i] < 0 || value[i] >= arr[i].size())
+        {
+            fail_lane(i, "cannot find the value at given index or array is not declared");
+            continue;
+        }
+
+        int &slot = arr[i][value[i]];
+        switch (ast->op.t)
+        {
+        case Token::ADD:
+            slot = LaneAdd::scalar(slot, operand[i]);
+            break;
+        case Token::MIN:
+            slot = std::min(slot, operand[i]);
+            break;
+        case Token::MAX:
+            slot = std::max(slot, operand[i]);
+            break;
+        default:
+            ok[i] = slot == operand[i];
+            if (ok[i])
+                slot = desired[i];
+        }
+    }
+
+    if (ast->op.t == Token::CAS)
+    {
+        LaneVector &result = nested_scopes.lookup_var(ast->result.text_data);
+        lanes_blend(result.data(), ok.data(), mask.data(), lanes);
+    }
+}
+
+inline void BatchInterpreter::visit(Spawn *ast)
+{
+    throw std::invalid_argument("batch mode does not support SPAWN, JOIN and YIELD");
+}
+
+inline void BatchInterpreter::visit(Join *ast)
+{
+    throw std::invalid_argument("batch mode does not support SPAWN, JOIN and YIELD");
+}
+
+inline void BatchInterpreter::visit(Yield *ast)
+{
+    throw std::invalid_argument("batch mode does not support SPAWN, JOIN and YIELD");
+}
+
+inline void BatchInterpreter::visit(ChanDecl *ast)
+{
+    throw std::invalid_argument("batch mode does not support CHAN, SEND and RECV");
+}
+
+inline void BatchInterpreter::visit(Send *ast)
+{
+    throw std::invalid_argument("batch mode does not support CHAN, SEND and RECV");
+}
+
+inline void BatchInterpreter::visit(Recv *ast)
+{
+    throw std::invalid_argument("batch mode does not support CHAN, SEND and RECV");
+}
+
+inline void BatchInterpreter::visit(NO_OP *ast)
+{
+    return;
+}
+
+inline void BatchInterpreter::interpret_fullprogram()
+{
+    tree->accept(*this);
+    tree->accept(deleter);
+
+    for (std::size_t i = 0; i < lanes; ++i)
+        outputs[i]->flush();
+}
+
+#endif
\ No newline at end of file
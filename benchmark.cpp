@@ -0,0 +1,350 @@
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <functional>
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include "program.h"
+
+//BENCHMARK
+//generates programs and inputs at a configurable scale, times lexing, parsing and execution
+//separately and prints one JSON object per workload and phase, so results can be diffed between builds.
+//
+//usage: benchmark [--scale S] [--repeat R] [--only NAME] [--out FILE] [--threads T]
+//--threads sizes the pool of the parallel built-ins, running the same workload with 1, 2, 4, ... threads shows how it scales
+
+struct Workload
+{
+    std::string name;
+    long long size;
+    std::string program;
+    std::string input;
+};
+
+static double now_ms()
+{
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+//WORKLOAD GENERATORS
+
+static Workload kadane(long long n)
+{
+    Workload w{"kadane", n};
+
+    w.program = "LET size\nREAD size\nLET array[size]\nLET i\ni = 0\nWHILE i<size\nREAD array[i]\ni = i + 1\nDONE\n"
+                "LET maxsum\nmaxsum = array[0]\nLET currsum\ncurrsum = maxsum\ni = 1\nWHILE i<size\n"
+                "IF currsum + array[i] < array[i]\ncurrsum = array[i]\nELSE\ncurrsum = currsum + array[i]\nENDIF\n"
+                "IF maxsum < currsum\nmaxsum = currsum\nENDIF\ni = i + 1\nDONE\nPRINT maxsum";
+
+    std::ostringstream input;
+    input << n << "\n";
+    unsigned seed = 12345;
+    for (long long i = 0; i < n; ++i)
+    {
+        seed = seed * 1103515245u + 12345u;
+        input << (int)((seed >> 16) % 201) - 100 << "\n";
+    }
+    w.input = input.str();
+
+    return w;
+}
+
+static Workload nested_loops(long long n)
+{
+    Workload w{"nested_loops", n * n};
+
+    std::ostringstream program;
+    program << "LET n\nn = " << n << "\nLET sum\nsum = 0\nLET i\ni = 0\nWHILE i < n\nLET j\nj = 0\n"
+            << "WHILE j < n\nsum = sum + i * j % 7\nj = j + 1\nDONE\ni = i + 1\nDONE\nPRINT sum";
+    w.program = program.str();
+
+    return w;
+}
+
+//GOTO can only jump forward, so the jumps skip over parts of the loop body
+static Workload goto_heavy(long long n)
+{
+    Workload w{"goto_heavy", n};
+
+    std::ostringstream program;
+    program << "LET n\nn = " << n << "\nLET x\nx = 0\nLET i\ni = 0\nWHILE i < n\n"
+            << "IF i % 2 == 0\nGOTO a\nENDIF\nx = x + 1\nLABEL a\n"
+            << "IF i % 3 == 0\nGOTO b\nENDIF\nx = x + 2\nLABEL b\n"
+            << "IF i % 5 == 0\nGOTO c\nENDIF\nx = x + 3\nLABEL c\n"
+            << "i = i + 1\nDONE\nPRINT x";
+    w.program = program.str();
+
+    return w;
+}
+
+//the parser refuses more than MAX_NESTING levels, the loop, its body and the assignment take three of them.
+//the modulo keeps the value small, a product at every third level would overflow after a few dozen
+static Workload deep_expression(long long depth)
+{
+    depth = std::min(depth, (long long)MAX_NESTING - 3);
+    Workload w{"deep_expression", depth};
+
+    std::string expr = "x";
+    for (long long i = 0; i < depth; ++i)
+        expr = "(" + expr + (i % 3 == 0 ? " + " : i % 3 == 1 ? " - " : " % ") + std::to_string(i % 5 + 2) + ")";
+
+    std::ostringstream program;
+    program << "LET x\nLET y\nLET i\ni = 0\nWHILE i < 1000\nx = i % 10\ny = " << expr << "\ni = i + 1\nDONE\nPRINT y";
+    w.program = program.str();
+
+    return w;
+}
+
+static Workload straight_line(long long lines)
+{
+    Workload w{"straight_line", lines};
+
+    std::ostringstream program;
+    program << "LET a\nLET b\na = 1\nb = 2\n";
+    for (long long i = 0; i < lines; ++i)
+    {
+        if (i % 2 == 0)
+            program << "a = a + b * " << i % 9 << "\n";
+        else
+            program << "b = b - a % " << i % 7 + 1 << "\n";
+    }
+    program << "PRINT a";
+    w.program = program.str();
+
+    return w;
+}
+
+//the same array work twice, once as BASIC loops and once with the built-in intrinsics;
+//both print the same numbers so the two results can be compared directly
+static const char *ARRAY_SETUP = "LET n\nREAD n\nLET a[n]\nLET b[n]\nLET i\ni = 0\nWHILE i < n\na[i] = i % 100 - 50\ni = i + 1\nDONE\n";
+
+static Workload array_loops(long long n)
+{
+    Workload w{"array_loops", n};
+
+    w.program = std::string(ARRAY_SETUP) +
+                "LET s\ns = 0\nLET hi\nhi = a[0]\nLET lo\nlo = a[0]\ni = 0\nWHILE i < n\ns = s + a[i]\n"
+                "IF hi < a[i]\nhi = a[i]\nENDIF\nIF a[i] < lo\nlo = a[i]\nENDIF\ni = i + 1\nDONE\n"
+                "i = 0\nWHILE i < n\nb[i] = a[i]\ni = i + 1\nDONE\n"
+                "LET d\nd = 0\ni = 0\nWHILE i < n\nd = d + a[i] * b[i]\ni = i + 1\nDONE\n"
+                "i = 0\nWHILE i < n\nb[i] = 3\ni = i + 1\nDONE\n"
+                "PRINT s\nPRINT hi\nPRINT lo\nPRINT d\nPRINT b[n - 1]";
+    w.input = std::to_string(n) + "\n";
+
+    return w;
+}
+
+static Workload array_intrinsics(long long n)
+{
+    Workload w{"array_intrinsics", n};
+
+    w.program = std::string(ARRAY_SETUP) +
+                "PRINT SUM(a, n)\nPRINT MAX(a, n)\nPRINT MIN(a, n)\nCOPY a TO b\nPRINT DOT(a, b, n)\n"
+                "FILL b, 3\nPRINT b[n - 1]";
+    w.input = std::to_string(n) + "\n";
+
+    return w;
+}
+
+//the accumulator loops of program_sum.txt and the kadane programs written as REDUCE
+static Workload reductions(long long n)
+{
+    Workload w{"reductions", n};
+
+    w.program = "LET n\nREAD n\nLET a[n]\nPARALLEL FOR i = 0 TO n - 1\na[i] = i % 100 - 50\nDONE\n"
+                "LET s\ns = 0\nREDUCE SUM s = a[i] * a[i] FOR i = 0 TO n - 1\n"
+                "LET hi\nhi = a[0]\nREDUCE MAX hi = a[i] + i % 7 FOR i = 0 TO n - 1\nPRINT s\nPRINT hi";
+    w.input = std::to_string(n) + "\n";
+
+    return w;
+}
+
+//every iteration hits one of 64 bins from all cores at once, the contention case of ATOMIC ADD and MAX
+static Workload atomic_histogram(long long n)
+{
+    Workload w{"atomic_histogram", n};
+
+    w.program = "LET n\nREAD n\nLET h[64]\nLET top[1]\nPARALLEL FOR i = 0 TO n - 1\n"
+                "ATOMIC ADD h[(i * 7919) % 64], 1\nATOMIC MAX top[0], (i * 7919) % 1000\nDONE\n"
+                "PRINT SUM(h, 64)\nPRINT h[5]\nPRINT top[0]";
+    w.input = std::to_string(n) + "\n";
+
+    return w;
+}
+
+//producer and consumer tasks pass n values through one channel, every pair moves n / pairs of them,
+//summed modulo 1000 so the total fits 32 bits. one pair is the single producer case, more pairs contend for both ends of the ring
+static Workload channel_pipeline(const char *name, long long n, int pairs)
+{
+    Workload w{name, n};
+
+    w.program = "LET n\nREAD n\nLET pairs\nREAD pairs\nCHAN c[256]\nLET total[pairs]\nLET p\n"
+                "WHILE p < pairs\nSPAWN producer, id = p\nSPAWN consumer, id = p\np = p + 1\nDONE\n"
+                "JOIN\nPRINT SUM(total, pairs)\nGOTO finish\n"
+                "LABEL producer\nLET i\ni = id\nWHILE i < n\nSEND c, i\ni = i + pairs\nDONE\nGOTO finish\n"
+                "LABEL consumer\nLET i\nLET v\ni = id\nWHILE i < n\nRECV c, v\nATOMIC ADD total[id], v % 1000\ni = i + pairs\nDONE\n"
+                "LABEL finish";
+    w.input = std::to_string(n) + "\n" + std::to_string(pairs) + "\n";
+
+    return w;
+}
+
+//n scattered ids in a SPARSE array of 10^9 elements are set, looked up again and walked with FOR IN
+static Workload sparse_lookup(long long n)
+{
+    Workload w{"sparse_lookup", n};
+
+    w.program = "LET n\nREAD n\nLET ids[1000000000] SPARSE\nLET i\n"
+                "WHILE i < n\nids[(i * 7919) % 1000000000] = i % 1000 + 1\ni = i + 1\nDONE\n"
+                "LET total\ni = 0\nWHILE i < n\ntotal = total + ids[(i * 7919) % 1000000000]\ni = i + 1\nDONE\n"
+                "LET count\nFOR k, v IN ids\ncount = count + 1\nDONE\nPRINT total\nPRINT count";
+    w.input = std::to_string(n) + "\n";
+
+    return w;
+}
+
+//MEASUREMENT
+
+static void lex_all(const std::string &program)
+{
+    Lexer lexer(program);
+    while (lexer.get_next_token().t != Token::END)
+        ;
+}
+
+static void print_stats(std::ostream &out, const Workload &w, const char *phase, std::vector<double> runs)
+{
+    std::sort(runs.begin(), runs.end());
+
+    double sum = 0;
+    for (int i = 0; i < runs.size(); ++i)
+        sum += runs[i];
+    double mean = sum / runs.size();
+
+    double variance = 0;
+    for (int i = 0; i < runs.size(); ++i)
+        variance += (runs[i] - mean) * (runs[i] - mean);
+    double stddev = runs.size() > 1 ? std::sqrt(variance / (runs.size() - 1)) : 0.0;
+
+    double median = runs.size() % 2 ? runs[runs.size() / 2] : (runs[runs.size() / 2 - 1] + runs[runs.size() / 2]) / 2;
+
+    out << "{\"workload\":\"" << w.name << "\",\"size\":" << w.size << ",\"phase\":\"" << phase
+        << "\",\"threads\":" << ThreadPool::shared().size() << ",\"runs\":" << runs.size() << ",\"min_ms\":" << runs.front() << ",\"median_ms\":" << median
+        << ",\"mean_ms\":" << mean << ",\"stddev_ms\":" << stddev << ",\"max_ms\":" << runs.back() << "}\n";
+}
+
+//a workload that fails gets one error record instead of its timings, the others still run
+static void print_error(std::ostream &out, const std::string &name, const std::string &message)
+{
+    std::string escaped;
+    for (char c : message)
+    {
+        if (c == '"' || c == '\\')
+            escaped += '\\';
+        escaped += c;
+    }
+
+    out << "{\"workload\":\"" << name << "\",\"error\":\"" << escaped << "\"}\n";
+    std::cerr << name << ": " << message << "\n";
+}
+
+static void measure(std::ostream &out, const Workload &w, int repeat)
+{
+    std::vector<double> lex_runs, parse_runs, exec_runs;
+    std::string result;
+
+    for (int r = 0; r < repeat; ++r)
+    {
+        double start = now_ms();
+        lex_all(w.program);
+        lex_runs.push_back(now_ms() - start);
+
+        //the parser pulls tokens from the lexer itself, so this phase includes a second lexing pass
+        start = now_ms();
+        CompiledProgram program = compile(w.program);
+        parse_runs.push_back(now_ms() - start);
+
+        ExecutionContext context;
+        StringInput input(w.input);
+        StringOutput output;
+
+        start = now_ms();
+        context.run(program, input, output);
+        exec_runs.push_back(now_ms() - start);
+
+        result = output.str();
+    }
+
+    print_stats(out, w, "lex", lex_runs);
+    print_stats(out, w, "parse", parse_runs);
+    print_stats(out, w, "execute", exec_runs);
+
+    //the printed value keeps the optimizer honest and makes wrong results visible in the log
+    std::cerr << w.name << " (" << w.size << "): " << result;
+}
+
+int main(int argc, char **argv)
+{
+    double scale = 1.0;
+    int repeat = 5;
+    std::string only, outname;
+
+    for (int i = 1; i < argc; ++i)
+    {
+        std::string arg = argv[i];
+        if (arg == "--scale" && i + 1 < argc)
+            scale = std::atof(argv[++i]);
+        else if (arg == "--repeat" && i + 1 < argc)
+            repeat = std::max(1, std::atoi(argv[++i]));
+        else if (arg == "--only" && i + 1 < argc)
+            only = argv[++i];
+        else if (arg == "--out" && i + 1 < argc)
+            outname = argv[++i];
+        else if (arg == "--threads" && i + 1 < argc)
+            setenv("BASIC_THREADS", argv[++i], 1);
+        else
+        {
+            std::cerr << "usage: benchmark [--scale S] [--repeat R] [--only NAME] [--out FILE] [--threads T]\n";
+            return 1;
+        }
+    }
+
+    std::vector<std::pair<std::string, std::function<Workload()>>> workloads = {
+        {"kadane", [scale]() { return kadane((long long)(100000 * scale)); }},
+        {"nested_loops", [scale]() { return nested_loops((long long)(300 * std::sqrt(scale))); }},
+        {"goto_heavy", [scale]() { return goto_heavy((long long)(100000 * scale)); }},
+        {"deep_expression", [scale]() { return deep_expression((long long)(200 * scale)); }},
+        {"straight_line", [scale]() { return straight_line((long long)(100000 * scale)); }},
+        {"array_loops", [scale]() { return array_loops((long long)(100000 * scale)); }},
+        {"array_intrinsics", [scale]() { return array_intrinsics((long long)(100000 * scale)); }},
+        {"reductions", [scale]() { return reductions((long long)(100000 * scale)); }},
+        {"atomic_histogram", [scale]() { return atomic_histogram((long long)(100000 * scale)); }},
+        {"channel_spsc", [scale]() { return channel_pipeline("channel_spsc", (long long)(100000 * scale), 1); }},
+        {"channel_mpmc", [scale]() { return channel_pipeline("channel_mpmc", (long long)(100000 * scale), 4); }},
+        {"sparse_lookup", [scale]() { return sparse_lookup((long long)(100000 * scale)); }},
+    };
+
+    std::ofstream file;
+    if (!outname.empty())
+        file.open(outname);
+    std::ostream &out = outname.empty() ? std::cout : file;
+
+    for (int i = 0; i < workloads.size(); ++i)
+    {
+        if (!only.empty() && workloads[i].first != only)
+            continue;
+
+        try
+        {
+            measure(out, workloads[i].second(), repeat);
+        }
+        catch (const std::exception &e)
+        {
+            print_error(out, workloads[i].first, e.what());
+        }
+    }
+}
\ No newline at end of file
@@ -0,0 +1,89 @@
+#pragma once
+
+#ifndef BIGNUM_HEADER
+#define BIGNUM_HEADER
+
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <vector>
+
+////BIG INTEGER////
+//sign and magnitude, the magnitude is little endian in base 2^32 without leading zero limbs
+struct BigInt
+{
+    bool negative;
+    std::vector<std::uint32_t> limbs;
+
+    BigInt(long long v = 0);
+
+    bool is_zero() const;
+    bool fits_long(long long &result) const;
+    std::string to_string() const;
+
+    static int compare_magnitude(const BigInt &a, const BigInt &b);
+    static int compare(const BigInt &a, const BigInt &b);
+
+    static BigInt add(const BigInt &a, const BigInt &b);
+    static BigInt sub(const BigInt &a, const BigInt &b);
+    static BigInt mul(const BigInt &a, const BigInt &b);
+    //truncates toward zero like the built in integer division, the remainder has the sign of a
+    static void divmod(const BigInt &a, const BigInt &b, BigInt &quotient, BigInt &remainder);
+
+private:
+    void trim();
+
+    static std::vector<std::uint32_t> add_magnitude(const std::vector<std::uint32_t> &a, const std::vector<std::uint32_t> &b);
+    //a must not be smaller than b
+    static std::vector<std::uint32_t> sub_magnitude(const std::vector<std::uint32_t> &a, const std::vector<std::uint32_t> &b);
+    static std::uint32_t divmod_small(std::vector<std::uint32_t> &a, std::uint32_t divisor);
+};
+
+////NUMBER////
+//an integer that lives inline while it fits in 64 bits and moves to a heap BigInt only when it doesn't;
+//every operation tries the inline path first, so small values cost about as much as plain integers
+class Number
+{
+private:
+    long long small;
+    BigInt *big; //null while the value is inline
+
+    static Number from_big(BigInt value);
+    BigInt as_big() const;
+
+public:
+    Number(long long v = 0);
+    Number(const Number &other);
+    Number(Number &&other);
+    Number &operator=(const Number &other);
+    Number &operator=(Number &&other);
+    ~Number();
+
+    bool is_small() const;
+    bool fits_long(long long &result) const;
+    std::string to_string() const;
+
+    explicit operator bool() const;
+
+    static Number add(const Number &a, const Number &b);
+    static Number sub(const Number &a, const Number &b);
+    static Number mul(const Number &a, const Number &b);
+    static Number div(const Number &a, const Number &b);
+    static Number mod(const Number &a, const Number &b);
+    static Number neg(const Number &a);
+
+    static int compare(const Number &a, const Number &b);
+
+    friend bool operator==(const Number &a, const Number &b) { return compare(a, b) == 0; }
+    friend bool operator!=(const Number &a, const Number &b) { return compare(a, b) != 0; }
+    friend bool operator<(const Number &a, const Number &b) { return compare(a, b) < 0; }
+    friend bool operator<=(const Number &a, const Number &b) { return compare(a, b) <= 0; }
+    friend bool operator>(const Number &a, const Number &b) { return compare(a, b) > 0; }
+    friend bool operator>=(const Number &a, const Number &b) { return compare(a, b) >= 0; }
+
+    friend std::ostream &operator<<(std::ostream &os, const Number &n) { return os << n.to_string(); }
+};
+
+#include "bignum.inl"
+
+#endif
\ No newline at end of file
@@ -0,0 +1,418 @@
+#ifndef BIGNUM_SOURCE
+#define BIGNUM_SOURCE
+
+#include <algorithm>
+#include <limits>
+
+//BIG INTEGER
+
+inline BigInt::BigInt(long long v) : negative(v < 0)
+{
+    //the magnitude is computed unsigned so LLONG_MIN does not overflow
+    unsigned long long magnitude = negative ? 0ull - (unsigned long long)v : (unsigned long long)v;
+
+    while (magnitude)
+    {
+        limbs.push_back((std::uint32_t)magnitude);
+        magnitude >>= 32;
+    }
+}
+
+inline void BigInt::trim()
+{
+    while (!limbs.empty() && limbs.back() == 0)
+        limbs.pop_back();
+
+    if (limbs.empty())
+        negative = false;
+}
+
+inline bool BigInt::is_zero() const
+{
+    return limbs.empty();
+}
+
+inline bool BigInt::fits_long(long long &result) const
+{
+    if (limbs.size() > 2)
+        return false;
+
+    unsigned long long magnitude = 0;
+    for (int i = (int)limbs.size() - 1; i >= 0; --i)
+        magnitude = (magnitude << 32) | limbs[i];
+
+    if (negative)
+    {
+        if (magnitude > (unsigned long long)std::numeric_limits<long long>::max() + 1)
+            return false;
+        result = (long long)(0ull - magnitude);
+    }
+    else
+    {
+        if (magnitude > (unsigned long long)std::numeric_limits<long long>::max())
+            return false;
+        result = (long long)magnitude;
+    }
+
+    return true;
+}
+
+inline std::uint32_t BigInt::divmod_small(std::vector<std::uint32_t> &a, std::uint32_t divisor)
+{
+    unsigned long long remainder = 0;
+    for (int i = (int)a.size() - 1; i >= 0; --i)
+    {
+        unsigned long long current = (remainder << 32) | a[i];
+        a[i] = (std::uint32_t)(current / divisor);
+        remainder = current % divisor;
+    }
+
+    while (!a.empty() && a.back() == 0)
+        a.pop_back();
+
+    return (std::uint32_t)remainder;
+}
+
+inline std::string BigInt::to_string() const
+{
+    if (limbs.empty())
+        return "0";
+
+    //peel off 9 decimal digits at a time
+    std::vector<std::uint32_t> rest = limbs;
+    std::vector<std::uint32_t> chunks;
+    while (!rest.empty())
+        chunks.push_back(divmod_small(rest, 1000000000u));
+
+    std::string result = negative ? "-" : "";
+    result += std::to_string(chunks.back());
+    for (int i = (int)chunks.size() - 2; i >= 0; --i)
+    {
+        std::string chunk = std::to_string(chunks[i]);
+        result += std::string(9 - chunk.size(), '0') + chunk;
+    }
+
+    return result;
+}
+
+inline int BigInt::compare_magnitude(const BigInt &a, const BigInt &b)
+{
+    if (a.limbs.size() != b.limbs.size())
+        return a.limbs.size() < b.limbs.size() ? -1 : 1;
+
+    for (int i = (int)a.limbs.size() - 1; i >= 0; --i)
+    {
+        if (a.limbs[i] != b.limbs[i])
+            return a.limbs[i] < b.limbs[i] ? -1 : 1;
+    }
+
+    return 0;
+}
+
+inline int BigInt::compare(const BigInt &a, const BigInt &b)
+{
+    if (a.negative != b.negative)
+        return a.negative ? -1 : 1;
+
+    int magnitude = compare_magnitude(a, b);
+    return a.negative ? -magnitude : magnitude;
+}
+
+inline std::vector<std::uint32_t> BigInt::add_magnitude(const std::vector<std::uint32_t> &a, const std::vector<std::uint32_t> &b)
+{
+    const std::vector<std::uint32_t> &longer = a.size() >= b.size() ? a : b;
+    const std::vector<std::uint32_t> &shorter = a.size() >= b.size() ? b : a;
+
+    std::vector<std::uint32_t> result(longer.size() + 1);
+    unsigned long long carry = 0;
+    for (std::size_t i = 0; i < longer.size(); ++i)
+    {
+        unsigned long long sum = carry + longer[i] + (i < shorter.size() ? shorter[i] : 0);
+        result[i] = (std::uint32_t)sum;
+        carry = sum >> 32;
+    }
+    result[longer.size()] = (std::uint32_t)carry;
+
+    return result;
+}
+
+inline std::vector<std::uint32_t> BigInt::sub_magnitude(const std::vector<std::uint32_t> &a, const std::vector<std::uint32_t> &b)
+{
+    std::vector<std::uint32_t> result(a.size());
+    long long borrow = 0;
+    for (std::size_t i = 0; i < a.size(); ++i)
+    {
+        long long difference = (long long)a[i] - (i < b.size() ? b[i] : 0) - borrow;
+        borrow = difference < 0;
+        result[i] = (std::uint32_t)(difference + (borrow << 32));
+    }
+
+    return result;
+}
+
+inline BigInt BigInt::add(const BigInt &a, const BigInt &b)
+{
+    BigInt result;
+
+    if (a.negative == b.negative)
+    {
+        result.limbs = add_magnitude(a.limbs, b.limbs);
+        result.negative = a.negative;
+    }
+    else if (compare_magnitude(a, b) >= 0)
+    {
+        result.limbs = sub_magnitude(a.limbs, b.limbs);
+        result.negative = a.negative;
+    }
+    else
+    {
+        result.limbs = sub_magnitude(b.limbs, a.limbs);
+        result.negative = b.negative;
+    }
+
+    result.trim();
+    return result;
+}
+
+inline BigInt BigInt::sub(const BigInt &a, const BigInt &b)
+{
+    BigInt negated = b;
+    negated.negative = !b.negative;
+    negated.trim();
+
+    return add(a, negated);
+}
+
+inline BigInt BigInt::mul(const BigInt &a, const BigInt &b)
+{
+    BigInt result;
+    if (a.is_zero() || b.is_zero())
+        return result;
+
+    result.limbs.assign(a.limbs.size() + b.limbs.size(), 0);
+    for (std::size_t i = 0; i < a.limbs.size(); ++i)
+    {
+        unsigned long long carry = 0;
+        for (std::size_t j = 0; j < b.limbs.size(); ++j)
+        {
+            unsigned long long current = (unsigned long long)a.limbs[i] * b.limbs[j] + result.limbs[i + j] + carry;
+            result.limbs[i + j] = (std::uint32_t)current;
+            carry = current >> 32;
+        }
+        result.limbs[i + b.limbs.size()] = (std::uint32_t)carry;
+    }
+
+    result.negative = a.negative != b.negative;
+    result.trim();
+    return result;
+}
+
+inline void BigInt::divmod(const BigInt &a, const BigInt &b, BigInt &quotient, BigInt &remainder)
+{
+    if (b.is_zero())
+        throw std::invalid_argument("cant divide by zero!");
+
+    quotient = BigInt();
+    remainder = BigInt();
+
+    if (b.limbs.size() == 1)
+    {
+        quotient.limbs = a.limbs;
+        remainder = BigInt(divmod_small(quotient.limbs, b.limbs[0]));
+    }
+    else
+    {
+        //shift-subtract long division, one bit of the dividend at a time
+        BigInt divisor = b;
+        divisor.negative = false;
+
+        quotient.limbs.assign(a.limbs.size(), 0);
+        for (int i = (int)a.limbs.size() * 32 - 1; i >= 0; --i)
+        {
+            remainder.limbs = add_magnitude(remainder.limbs, remainder.limbs);
+            if (remainder.limbs.empty())
+                remainder.limbs.push_back(0);
+            remainder.limbs[0] |= (a.limbs[i / 32] >> (i % 32)) & 1u;
+            remainder.trim();
+
+            if (compare_magnitude(remainder, divisor) >= 0)
+            {
+                remainder.limbs = sub_magnitude(remainder.limbs, divisor.limbs);
+                remainder.trim();
+                quotient.limbs[i / 32] |= 1u << (i % 32);
+            }
+        }
+    }
+
+    quotient.negative = a.negative != b.negative;
+    quotient.trim();
+    remainder.negative = a.negative;
+    remainder.trim();
+}
+
+//NUMBER
+
+inline Number::Number(long long v) : small(v), big(nullptr)
+{
+}
+
+inline Number::Number(const Number &other) : small(other.small), big(other.big ? new BigInt(*other.big) : nullptr)
+{
+}
+
+inline Number::Number(Number &&other) : small(other.small), big(other.big)
+{
+    other.big = nullptr;
+}
+
+inline Number &Number::operator=(const Number &other)
+{
+    if (this != &other)
+    {
+        BigInt *copy = other.big ? new BigInt(*other.big) : nullptr;
+        delete big;
+        big = copy;
+        small = other.small;
+    }
+
+    return *this;
+}
+
+inline Number &Number::operator=(Number &&other)
+{
+    if (this != &other)
+    {
+        delete big;
+        big = other.big;
+        small = other.small;
+        other.big = nullptr;
+    }
+
+    return *this;
+}
+
+inline Number::~Number()
+{
+    delete big;
+}
+
+//results that fit again go back inline, so a value only stays on the heap while it needs to
+inline Number Number::from_big(BigInt value)
+{
+    long long fits;
+    if (value.fits_long(fits))
+        return Number(fits);
+
+    Number result;
+    result.big = new BigInt(std::move(value));
+    return result;
+}
+
+inline BigInt Number::as_big() const
+{
+    return big ? *big : BigInt(small);
+}
+
+inline bool Number::is_small() const
+{
+    return !big;
+}
+
+inline bool Number::fits_long(long long &result) const
+{
+    if (!big)
+    {
+        result = small;
+        return true;
+    }
+
+    return big->fits_long(result);
+}
+
+inline std::string Number::to_string() const
+{
+    return big ? big->to_string() : std::to_string(small);
+}
+
+inline Number::operator bool() const
+{
+    //a heap value is never zero, zero always fits inline
+    return big || small;
+}
+
+inline Number Number::add(const Number &a, const Number &b)
+{
+    long long result;
+    if (__builtin_expect(!a.big && !b.big && !__builtin_add_overflow(a.small, b.small, &result), 1))
+        return Number(result);
+
+    return from_big(BigInt::add(a.as_big(), b.as_big()));
+}
+
+inline Number Number::sub(const Number &a, const Number &b)
+{
+    long long result;
+    if (__builtin_expect(!a.big && !b.big && !__builtin_sub_overflow(a.small, b.small, &result), 1))
+        return Number(result);
+
+    return from_big(BigInt::sub(a.as_big(), b.as_big()));
+}
+
+inline Number Number::mul(const Number &a, const Number &b)
+{
+    long long result;
+    if (__builtin_expect(!a.big && !b.big && !__builtin_mul_overflow(a.small, b.small, &result), 1))
+        return Number(result);
+
+    return from_big(BigInt::mul(a.as_big(), b.as_big()));
+}
+
+inline Number Number::div(const Number &a, const Number &b)
+{
+    if (!b)
+        throw std::invalid_argument("cant divide by zero!");
+
+    //LLONG_MIN / -1 is the only inline quotient that does not fit
+    if (!a.big && !b.big && !(b.small == -1 && a.small == std::numeric_limits<long long>::min()))
+        return Number(a.small / b.small);
+
+    BigInt quotient, remainder;
+    BigInt::divmod(a.as_big(), b.as_big(), quotient, remainder);
+    return from_big(quotient);
+}
+
+inline Number Number::mod(const Number &a, const Number &b)
+{
+    if (!b)
+        throw std::invalid_argument("cant divide by zero!");
+
+    if (!a.big && !b.big)
+        return Number(b.small == -1 ? 0 : a.small % b.small);
+
+    BigInt quotient, remainder;
+    BigInt::divmod(a.as_big(), b.as_big(), quotient, remainder);
+    return from_big(remainder);
+}
+
+inline Number Number::neg(const Number &a)
+{
+    if (!a.big && a.small != std::numeric_limits<long long>::min())
+        return Number(-a.small);
+
+    BigInt result = a.as_big();
+    result.negative = !result.negative;
+    if (result.is_zero())
+        result.negative = false;
+
+    return from_big(result);
+}
+
+inline int Number::compare(const Number &a, const Number &b)
+{
+    if (!a.big && !b.big)
+        return a.small < b.small ? -1 : a.small > b.small;
+
+    return BigInt::compare(a.as_big(), b.as_big());
+}
+
+#endif
\ No newline at end of file
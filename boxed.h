@@ -0,0 +1,75 @@
+#pragma once
+
+#ifndef BOXED_HEADER
+#define BOXED_HEADER
+
+#include <cstdint>
+#include <ostream>
+#include <string>
+
+////BOXED VALUE////
+//a double or a 32 bit integer packed in one 64 bit word. doubles are stored as their own bits,
+//integers live in the payload of a NaN pattern that real arithmetic never produces:
+//
+//  double   any bit pattern except the integer tag, every NaN is stored as CANONICAL_NAN
+//  integer  0xFFF9 0000 xxxx xxxx  where xxxx xxxx is the int
+//
+//so arrays stay 8 bytes per element and integer math never touches the FPU.
+class Boxed
+{
+private:
+    std::uint64_t bits;
+
+    static constexpr std::uint64_t INT_TAG = 0xFFF9000000000000ull;
+    static constexpr std::uint64_t TAG_MASK = 0xFFFFFFFF00000000ull;
+    static constexpr std::uint64_t CANONICAL_NAN = 0x7FF8000000000000ull;
+
+public:
+    Boxed(int v = 0);
+    //wider integers and doubles keep their value like from_long and from_double instead of being cut to an int;
+    //unsigned types are ambiguous on purpose and need one of the factories
+    Boxed(long v);
+    Boxed(long long v);
+    Boxed(double d);
+    static Boxed from_double(double d);
+    //integers that do not fit the 32 bit payload become doubles
+    static Boxed from_long(long long v);
+
+    bool is_int() const;
+    int as_int() const;
+    //the value as a double whatever its representation
+    double as_double() const;
+
+    bool fits_long(long long &result) const;
+    std::string to_string() const;
+
+    explicit operator bool() const;
+
+    //int op int stays an int, overflow moves the result to a double; anything with a double is a double.
+    //int / int and int % int truncate like the other builds so existing programs keep their meaning
+    static Boxed add(const Boxed &a, const Boxed &b);
+    static Boxed sub(const Boxed &a, const Boxed &b);
+    static Boxed mul(const Boxed &a, const Boxed &b);
+    static Boxed div(const Boxed &a, const Boxed &b);
+    static Boxed mod(const Boxed &a, const Boxed &b);
+    static Boxed neg(const Boxed &a);
+
+    //-1, 0 or 1, and UNORDERED when a NaN is involved so every ordered comparison is false like for doubles
+    static constexpr int UNORDERED = 2;
+    static int compare(const Boxed &a, const Boxed &b);
+
+    friend bool operator==(const Boxed &a, const Boxed &b) { return compare(a, b) == 0; }
+    friend bool operator!=(const Boxed &a, const Boxed &b) { return compare(a, b) != 0; }
+    friend bool operator<(const Boxed &a, const Boxed &b) { return compare(a, b) == -1; }
+    friend bool operator<=(const Boxed &a, const Boxed &b) { int c = compare(a, b); return c == -1 || c == 0; }
+    friend bool operator>(const Boxed &a, const Boxed &b) { return compare(a, b) == 1; }
+    friend bool operator>=(const Boxed &a, const Boxed &b) { int c = compare(a, b); return c == 1 || c == 0; }
+
+    friend std::ostream &operator<<(std::ostream &os, const Boxed &b) { return os << b.to_string(); }
+};
+
+static_assert(sizeof(Boxed) == 8, "boxed values must keep arrays at 8 bytes per element");
+
+#include "boxed.inl"
+
+#endif
\ No newline at end of file
@@ -0,0 +1,178 @@
+#ifndef BOXED_SOURCE
+#define BOXED_SOURCE
+
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <stdexcept>
+
+inline Boxed::Boxed(int v) : bits(INT_TAG | (std::uint32_t)v)
+{
+}
+
+inline Boxed Boxed::from_double(double d)
+{
+    Boxed result;
+    if (d != d)
+        result.bits = CANONICAL_NAN;
+    else
+        std::memcpy(&result.bits, &d, sizeof(d));
+
+    return result;
+}
+
+inline Boxed Boxed::from_long(long long v)
+{
+    if (v == (int)v)
+        return Boxed((int)v);
+
+    return from_double((double)v);
+}
+
+inline Boxed::Boxed(long v) : bits(from_long(v).bits)
+{
+}
+
+inline Boxed::Boxed(long long v) : bits(from_long(v).bits)
+{
+}
+
+inline Boxed::Boxed(double d) : bits(from_double(d).bits)
+{
+}
+
+inline bool Boxed::is_int() const
+{
+    return (bits & TAG_MASK) == INT_TAG;
+}
+
+inline int Boxed::as_int() const
+{
+    return (int)(std::uint32_t)bits;
+}
+
+inline double Boxed::as_double() const
+{
+    if (is_int())
+        return as_int();
+
+    double d;
+    std::memcpy(&d, &bits, sizeof(d));
+    return d;
+}
+
+inline bool Boxed::fits_long(long long &result) const
+{
+    if (is_int())
+    {
+        result = as_int();
+        return true;
+    }
+
+    //a double can stand for a size or an index only when it is a whole number
+    double d = as_double();
+    if (!(d >= -9.2e18 && d <= 9.2e18) || d != std::floor(d))
+        return false;
+
+    result = (long long)d;
+    return true;
+}
+
+inline std::string Boxed::to_string() const
+{
+    if (is_int())
+        return std::to_string(as_int());
+
+    //the shortest of the two precisions that reads back as the same double
+    char buffer[32];
+    double d = as_double();
+    std::snprintf(buffer, sizeof(buffer), "%.15g", d);
+    if (std::strtod(buffer, nullptr) != d)
+        std::snprintf(buffer, sizeof(buffer), "%.17g", d);
+
+    return buffer;
+}
+
+inline Boxed::operator bool() const
+{
+    if (is_int())
+        return as_int() != 0;
+
+    return as_double() != 0.0;
+}
+
+inline Boxed Boxed::add(const Boxed &a, const Boxed &b)
+{
+    int result;
+    if (__builtin_expect(a.is_int() && b.is_int() && !__builtin_add_overflow(a.as_int(), b.as_int(), &result), 1))
+        return Boxed(result);
+
+    return from_double(a.as_double() + b.as_double());
+}
+
+inline Boxed Boxed::sub(const Boxed &a, const Boxed &b)
+{
+    int result;
+    if (__builtin_expect(a.is_int() && b.is_int() && !__builtin_sub_overflow(a.as_int(), b.as_int(), &result), 1))
+        return Boxed(result);
+
+    return from_double(a.as_double() - b.as_double());
+}
+
+inline Boxed Boxed::mul(const Boxed &a, const Boxed &b)
+{
+    int result;
+    if (__builtin_expect(a.is_int() && b.is_int() && !__builtin_mul_overflow(a.as_int(), b.as_int(), &result), 1))
+        return Boxed(result);
+
+    return from_double(a.as_double() * b.as_double());
+}
+
+inline Boxed Boxed::div(const Boxed &a, const Boxed &b)
+{
+    if (!b)
+        throw std::invalid_argument("cant divide by zero!");
+
+    if (a.is_int() && b.is_int())
+        return from_long((long long)a.as_int() / b.as_int());
+
+    return from_double(a.as_double() / b.as_double());
+}
+
+inline Boxed Boxed::mod(const Boxed &a, const Boxed &b)
+{
+    if (!b)
+        throw std::invalid_argument("cant divide by zero!");
+
+    if (a.is_int() && b.is_int())
+        return Boxed(b.as_int() == -1 ? 0 : a.as_int() % b.as_int());
+
+    return from_double(std::fmod(a.as_double(), b.as_double()));
+}
+
+inline Boxed Boxed::neg(const Boxed &a)
+{
+    if (a.is_int())
+        return from_long(-(long long)a.as_int());
+
+    return from_double(-a.as_double());
+}
+
+inline int Boxed::compare(const Boxed &a, const Boxed &b)
+{
+    if (a.is_int() && b.is_int())
+        return a.as_int() < b.as_int() ? -1 : a.as_int() > b.as_int();
+
+    double x = a.as_double(), y = b.as_double();
+    if (x < y)
+        return -1;
+    if (x > y)
+        return 1;
+    if (x == y)
+        return 0;
+
+    return UNORDERED;
+}
+
+#endif
\ No newline at end of file
@@ -0,0 +1,50 @@
+#pragma once
+
+#ifndef CHANNEL_HEADER
+#define CHANNEL_HEADER
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+
+////CHANNELS////
+//the bounded queue behind CHAN, SEND and RECV: a lock free ring where every cell carries a sequence number
+//telling whether it waits for a sender or a receiver of the current lap. senders and receivers each claim
+//a position with one compare and swap, so any number of producers and consumers can use it, one of each
+//pays only for that uncontended swap
+class Channel
+{
+public:
+    explicit Channel(std::size_t _capacity);
+
+    Channel(const Channel &) = delete;
+    Channel &operator=(const Channel &) = delete;
+
+    //both return false instead of waiting when the channel is full or empty
+    bool try_send(const value_t &v);
+    bool try_recv(value_t &v);
+
+    //completed sends and receives, a blocked task parks on the counter that has to move before it can go on
+    const std::atomic<std::size_t> &sent() const;
+    const std::atomic<std::size_t> &received() const;
+
+private:
+    struct Cell
+    {
+        std::atomic<std::size_t> sequence;
+        value_t data;
+    };
+
+    std::size_t capacity;
+    std::unique_ptr<Cell[]> cells;
+
+    //the two ends live on their own cache lines so producers and consumers don't slow each other down
+    alignas(64) std::atomic<std::size_t> tail; //next position to send to
+    alignas(64) std::atomic<std::size_t> head; //next position to receive from
+    alignas(64) std::atomic<std::size_t> sends;
+    alignas(64) std::atomic<std::size_t> receives;
+};
+
+#include "channel.inl"
+
+#endif
\ No newline at end of file
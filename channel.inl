@@ -0,0 +1,78 @@
+#ifndef CHANNEL_SOURCE
+#define CHANNEL_SOURCE
+
+inline Channel::Channel(std::size_t _capacity)
+    : capacity(_capacity), cells(new Cell[_capacity]), tail(0), head(0), sends(0), receives(0)
+{
+    for (std::size_t i = 0; i < capacity; ++i)
+        cells[i].sequence.store(i, std::memory_order_relaxed);
+}
+
+//a cell is free for the sender of position pos when its sequence is pos,
+//and holds the value for the receiver of pos once the sender set it to pos + 1
+inline bool Channel::try_send(const value_t &v)
+{
+    std::size_t pos = tail.load(std::memory_order_relaxed);
+
+    while (true)
+    {
+        Cell &cell = cells[pos % capacity];
+        std::size_t sequence = cell.sequence.load(std::memory_order_acquire);
+        std::ptrdiff_t lap = (std::ptrdiff_t)(sequence - pos);
+
+        if (lap == 0)
+        {
+            if (tail.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+            {
+                cell.data = v;
+                cell.sequence.store(pos + 1, std::memory_order_release);
+                sends.fetch_add(1);
+                return true;
+            }
+        }
+        else if (lap < 0)
+            return false; //the receiver of the previous lap hasn't taken this cell yet, the channel is full
+        else
+            pos = tail.load(std::memory_order_relaxed);
+    }
+}
+
+//after taking the value the cell is handed to the sender of the next lap, pos + capacity
+inline bool Channel::try_recv(value_t &v)
+{
+    std::size_t pos = head.load(std::memory_order_relaxed);
+
+    while (true)
+    {
+        Cell &cell = cells[pos % capacity];
+        std::size_t sequence = cell.sequence.load(std::memory_order_acquire);
+        std::ptrdiff_t lap = (std::ptrdiff_t)(sequence - (pos + 1));
+
+        if (lap == 0)
+        {
+            if (head.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+            {
+                v = cell.data;
+                cell.sequence.store(pos + capacity, std::memory_order_release);
+                receives.fetch_add(1);
+                return true;
+            }
+        }
+        else if (lap < 0)
+            return false; //nothing was sent to this position yet, the channel is empty
+        else
+            pos = head.load(std::memory_order_relaxed);
+    }
+}
+
+inline const std::atomic<std::size_t> &Channel::sent() const
+{
+    return sends;
+}
+
+inline const std::atomic<std::size_t> &Channel::received() const
+{
+    return receives;
+}
+
+#endif
\ No newline at end of file
@@ -0,0 +1,141 @@
+#pragma once
+
+#ifndef DAEMON_HEADER
+#define DAEMON_HEADER
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <system_error>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include "runner.h"
+
+////PROGRAM CACHE////
+//compiled programs by the 64 bit FNV-1a hash of their text, the least recently used one is evicted first.
+//the programs are shared, so one can keep running while it is evicted. FNV collisions are easy to make,
+//so a text whose hash already belongs to another cached text is compiled every time and gets key 0,
+//which no program is cached under: a key never stands for two programs
+class ProgramCache
+{
+public:
+    explicit ProgramCache(std::size_t _capacity);
+
+    //never 0
+    static std::uint64_t key_of(const std::string &source);
+
+    //compiles the program on a miss; hit tells whether it was cached, key is 0 when it couldn't be cached
+    std::shared_ptr<const CompiledProgram> get(const std::string &source, std::uint64_t &key, bool &hit);
+    //null when no program has that key
+    std::shared_ptr<const CompiledProgram> find(std::uint64_t key);
+
+    std::size_t size() const;
+
+private:
+    struct Entry
+    {
+        std::string source; //a text with the same hash but different from this one isn't cached
+        std::shared_ptr<const CompiledProgram> program;
+        std::list<std::uint64_t>::iterator age;
+    };
+
+    mutable std::mutex lock;
+    std::size_t capacity;
+    std::unordered_map<std::uint64_t, Entry> entries;
+    std::list<std::uint64_t> ages; //most recently used first
+
+    void touch(Entry &entry);
+};
+
+////DAEMON////
+//a long lived server on a Unix domain socket. every frame on the connection is a little endian u32 length
+//followed by that many bytes. a request is one of
+//    'P' u32 length, program text, u32 length, input    run the program, compiling it unless it is cached
+//    'K' u64 key, u32 length, input                     run a cached program by the key an earlier reply gave,
+//                                                        a reply with key 0 means the program has to be sent again
+//    'S'                                                 the daemon's counters as text in the output
+//and every reply is
+//    u8 status ('O' ok, 'E' error, 'M' no program with that key), u8 cache hit, u64 key,
+//    u64 compile ns, u64 execute ns, u32 length, output, u32 length, error message
+//a connection may send any number of requests, each gets its reply before the next is read
+
+struct DaemonStats
+{
+    std::atomic<std::uint64_t> requests{0};
+    std::atomic<std::uint64_t> cache_hits{0};
+    std::atomic<std::uint64_t> cache_misses{0};
+    std::atomic<std::uint64_t> errors{0};
+    std::atomic<std::uint64_t> compile_ns{0};
+    std::atomic<std::uint64_t> execute_ns{0};
+};
+
+class Daemon
+{
+public:
+    //frames above this size close the connection
+    static const std::uint32_t MAX_FRAME = 64 * 1024 * 1024;
+    //a connection that sends or takes nothing for this long is closed, so idle clients don't hold the workers
+    static const int IDLE_TIMEOUT_MS = 1000;
+
+    //workers 0 means ThreadPool::default_size(); a stale socket file at path is replaced
+    Daemon(const std::string &_path, std::size_t workers, std::size_t cache_capacity = 256);
+    ~Daemon();
+
+    Daemon(const Daemon &) = delete;
+    Daemon &operator=(const Daemon &) = delete;
+
+    //serves until stop() is called
+    void run();
+    //can be called from any thread, a worker still serving a connection stops once its client closes it or goes idle
+    void stop();
+
+    const DaemonStats &stats() const;
+
+private:
+    std::string path;
+    int listener;
+    std::size_t worker_count;
+    std::atomic<bool> stopping;
+
+    ProgramCache cache;
+    DaemonStats counters;
+
+    //every worker takes a connection from the listener and serves it until the client closes it or goes idle,
+    //running the requests on its own execution context
+    void worker();
+    void serve(int fd, ExecutionContext &context);
+    std::string handle(const std::string &request, ExecutionContext &context);
+    std::string stats_text() const;
+
+    //walks a request, every read fails once the bytes run out
+    struct FrameReader
+    {
+        const std::string &data;
+        std::size_t pos;
+
+        bool u8(char &v);
+        bool u32(std::uint32_t &v);
+        bool u64(std::uint64_t &v);
+        bool bytes(std::string &v);
+    };
+
+    static void put_u32(std::string &out, std::uint32_t v);
+    static void put_u64(std::string &out, std::uint64_t v);
+    static bool read_full(int fd, char *data, std::size_t size);
+    static bool write_full(int fd, const char *data, std::size_t size);
+};
+
+#include "daemon.inl"
+
+#endif
\ No newline at end of file
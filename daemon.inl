@@ -0,0 +1,388 @@
+#ifndef DAEMON_SOURCE
+#define DAEMON_SOURCE
+
+//PROGRAM CACHE
+
+inline ProgramCache::ProgramCache(std::size_t _capacity) : capacity(_capacity ? _capacity : 1)
+{
+}
+
+inline std::uint64_t ProgramCache::key_of(const std::string &source)
+{
+    std::uint64_t hash = 14695981039346656037ull;
+    for (std::size_t i = 0; i < source.size(); ++i)
+    {
+        hash ^= (unsigned char)source[i];
+        hash *= 1099511628211ull;
+    }
+    return hash ? hash : 1;
+}
+
+inline void ProgramCache::touch(Entry &entry)
+{
+    ages.splice(ages.begin(), ages, entry.age);
+}
+
+//compiling happens outside the lock, two workers missing on the same text both compile it and the later one is kept.
+//a different text that is cached under the same key stays, this one is run without being cached
+inline std::shared_ptr<const CompiledProgram> ProgramCache::get(const std::string &source, std::uint64_t &key, bool &hit)
+{
+    key = key_of(source);
+
+    {
+        std::lock_guard<std::mutex> guard(lock);
+        std::unordered_map<std::uint64_t, Entry>::iterator got = entries.find(key);
+        if (got != entries.end() && got->second.source == source)
+        {
+            touch(got->second);
+            hit = true;
+            return got->second.program;
+        }
+    }
+
+    hit = false;
+    std::shared_ptr<const CompiledProgram> program = std::make_shared<CompiledProgram>(compile(source));
+
+    std::lock_guard<std::mutex> guard(lock);
+    std::unordered_map<std::uint64_t, Entry>::iterator got = entries.find(key);
+    if (got != entries.end())
+    {
+        if (got->second.source != source)
+            key = 0;
+        else
+        {
+            got->second.program = program;
+            touch(got->second);
+        }
+        return program;
+    }
+
+    if (entries.size() >= capacity)
+    {
+        entries.erase(ages.back());
+        ages.pop_back();
+    }
+
+    ages.push_front(key);
+    entries[key] = Entry{source, program, ages.begin()};
+    return program;
+}
+
+inline std::shared_ptr<const CompiledProgram> ProgramCache::find(std::uint64_t key)
+{
+    std::lock_guard<std::mutex> guard(lock);
+    std::unordered_map<std::uint64_t, Entry>::iterator got = entries.find(key);
+    if (got == entries.end())
+        return nullptr;
+
+    touch(got->second);
+    return got->second.program;
+}
+
+inline std::size_t ProgramCache::size() const
+{
+    std::lock_guard<std::mutex> guard(lock);
+    return entries.size();
+}
+
+//FRAMES
+
+inline bool Daemon::FrameReader::u8(char &v)
+{
+    if (data.size() - pos < 1)
+        return false;
+    v = data[pos++];
+    return true;
+}
+
+inline bool Daemon::FrameReader::u32(std::uint32_t &v)
+{
+    if (data.size() - pos < 4)
+        return false;
+
+    v = 0;
+    for (int i = 3; i >= 0; --i)
+        v = (v << 8) | (unsigned char)data[pos + i];
+    pos += 4;
+    return true;
+}
+
+inline bool Daemon::FrameReader::u64(std::uint64_t &v)
+{
+    if (data.size() - pos < 8)
+        return false;
+
+    v = 0;
+    for (int i = 7; i >= 0; --i)
+        v = (v << 8) | (unsigned char)data[pos + i];
+    pos += 8;
+    return true;
+}
+
+inline bool Daemon::FrameReader::bytes(std::string &v)
+{
+    std::uint32_t size;
+    if (!u32(size) || data.size() - pos < size)
+        return false;
+
+    v.assign(data, pos, size);
+    pos += size;
+    return true;
+}
+
+inline void Daemon::put_u32(std::string &out, std::uint32_t v)
+{
+    for (int i = 0; i < 4; ++i)
+        out.push_back((char)(v >> (8 * i)));
+}
+
+inline void Daemon::put_u64(std::string &out, std::uint64_t v)
+{
+    for (int i = 0; i < 8; ++i)
+        out.push_back((char)(v >> (8 * i)));
+}
+
+inline bool Daemon::read_full(int fd, char *data, std::size_t size)
+{
+    while (size)
+    {
+        ssize_t got = recv(fd, data, size, 0);
+        if (got < 0 && errno == EINTR)
+            continue;
+        if (got <= 0)
+            return false;
+
+        data += got;
+        size -= got;
+    }
+    return true;
+}
+
+inline bool Daemon::write_full(int fd, const char *data, std::size_t size)
+{
+    while (size)
+    {
+        ssize_t put = send(fd, data, size, MSG_NOSIGNAL);
+        if (put < 0 && errno == EINTR)
+            continue;
+        if (put < 0)
+            return false;
+
+        data += put;
+        size -= put;
+    }
+    return true;
+}
+
+//DAEMON
+
+inline Daemon::Daemon(const std::string &_path, std::size_t workers, std::size_t cache_capacity)
+    : path(_path), listener(-1), worker_count(workers ? workers : ThreadPool::default_size()), stopping(false),
+      cache(cache_capacity)
+{
+    sockaddr_un address{};
+    address.sun_family = AF_UNIX;
+    if (path.size() >= sizeof(address.sun_path))
+        throw std::invalid_argument("socket path is too long");
+    path.copy(address.sun_path, path.size());
+
+    listener = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (listener < 0)
+        throw std::system_error(errno, std::generic_category(), "socket");
+
+    unlink(path.c_str());
+    if (bind(listener, (sockaddr *)&address, sizeof(address)) < 0 || listen(listener, SOMAXCONN) < 0)
+    {
+        int error = errno;
+        close(listener);
+        throw std::system_error(error, std::generic_category(), "bind");
+    }
+}
+
+inline Daemon::~Daemon()
+{
+    close(listener);
+    unlink(path.c_str());
+}
+
+inline const DaemonStats &Daemon::stats() const
+{
+    return counters;
+}
+
+inline void Daemon::run()
+{
+    std::vector<std::thread> workers;
+    for (std::size_t i = 0; i < worker_count; ++i)
+        workers.push_back(std::thread(&Daemon::worker, this));
+
+    for (std::size_t i = 0; i < workers.size(); ++i)
+        workers[i].join();
+}
+
+//shutting the listener down wakes every worker blocked in accept
+inline void Daemon::stop()
+{
+    stopping = true;
+    shutdown(listener, SHUT_RDWR);
+}
+
+inline void Daemon::worker()
+{
+    ExecutionContext context;
+
+    while (!stopping)
+    {
+        int fd = accept4(listener, nullptr, nullptr, SOCK_CLOEXEC);
+        if (fd < 0)
+        {
+            if (errno == EINTR || errno == ECONNABORTED)
+                continue;
+            if (errno == EMFILE || errno == ENFILE)
+            {
+                std::this_thread::sleep_for(std::chrono::milliseconds(10));
+                continue;
+            }
+            return;
+        }
+
+        //a recv or send that waits longer fails with EAGAIN and serve drops the connection
+        timeval idle{IDLE_TIMEOUT_MS / 1000, (IDLE_TIMEOUT_MS % 1000) * 1000};
+        setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &idle, sizeof(idle));
+        setsockopt(fd, SOL_SOCKET, SO_SNDTIMEO, &idle, sizeof(idle));
+
+        serve(fd, context);
+        close(fd);
+    }
+}
+
+inline void Daemon::serve(int fd, ExecutionContext &context)
+{
+    std::string request, reply;
+
+    while (!stopping)
+    {
+        char header[4];
+        if (!read_full(fd, header, 4))
+            return;
+
+        std::uint32_t size = 0;
+        if (!FrameReader{std::string(header, 4), 0}.u32(size) || size > MAX_FRAME)
+            return;
+
+        request.resize(size);
+        if (!read_full(fd, &request[0], size))
+            return;
+
+        std::string body = handle(request, context);
+
+        reply.clear();
+        put_u32(reply, body.size());
+        reply += body;
+        if (!write_full(fd, reply.data(), reply.size()))
+            return;
+    }
+}
+
+inline std::string Daemon::handle(const std::string &request, ExecutionContext &context)
+{
+    ++counters.requests;
+
+    FrameReader reader{request, 0};
+    char kind = 0;
+    reader.u8(kind);
+
+    char status = 'O';
+    bool hit = false;
+    std::uint64_t key = 0;
+    std::chrono::nanoseconds compile_time(0), execute_time(0);
+    std::string output, error;
+
+    std::string source, input;
+    std::shared_ptr<const CompiledProgram> program;
+    bool looked_up = false; //a 'P' request that went to the cache
+
+    try
+    {
+        if (kind == 'S')
+            output = stats_text();
+        else if (kind == 'P' && reader.bytes(source) && reader.bytes(input))
+        {
+            looked_up = true;
+            std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+            program = cache.get(source, key, hit);
+            if (!hit)
+                compile_time = std::chrono::steady_clock::now() - start;
+        }
+        else if (kind == 'K' && reader.u64(key) && reader.bytes(input))
+        {
+            program = cache.find(key);
+            hit = program != nullptr;
+            if (!hit)
+                status = 'M';
+        }
+        else
+            throw std::invalid_argument("malformed request");
+    }
+    catch (const std::exception &e)
+    {
+        status = 'E';
+        error = e.what();
+    }
+
+    //a program that fails to compile was a miss as well
+    if (hit)
+        ++counters.cache_hits;
+    else if (looked_up)
+        ++counters.cache_misses;
+
+    if (program)
+    {
+        StringInput in(input);
+        StringOutput out;
+
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        try
+        {
+            context.run(*program, in, out);
+        }
+        catch (const std::exception &e)
+        {
+            status = 'E';
+            error = e.what();
+        }
+        execute_time = std::chrono::steady_clock::now() - start;
+        output = out.str();
+    }
+
+    if (status != 'O')
+        ++counters.errors;
+    counters.compile_ns += compile_time.count();
+    counters.execute_ns += execute_time.count();
+
+    std::string body;
+    body.push_back(status);
+    body.push_back(hit ? 1 : 0);
+    put_u64(body, key);
+    put_u64(body, compile_time.count());
+    put_u64(body, execute_time.count());
+    put_u32(body, output.size());
+    body += output;
+    put_u32(body, error.size());
+    body += error;
+    return body;
+}
+
+inline std::string Daemon::stats_text() const
+{
+    return "requests " + std::to_string(counters.requests.load()) + "\n" +
+           "cache_hits " + std::to_string(counters.cache_hits.load()) + "\n" +
+           "cache_misses " + std::to_string(counters.cache_misses.load()) + "\n" +
+           "errors " + std::to_string(counters.errors.load()) + "\n" +
+           "cached_programs " + std::to_string(cache.size()) + "\n" +
+           "compile_ms " + std::to_string(counters.compile_ns.load() / 1000000) + "\n" +
+           "execute_ms " + std::to_string(counters.execute_ns.load() / 1000000) + "\n" +
+           "workers " + std::to_string(worker_count) + "\n";
+}
+
+#endif
\ No newline at end of file
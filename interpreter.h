@@ -4,15 +4,31 @@
 #define INTERPRETER_HEADER
 
 #include <stdexcept>
+#include <exception>
+#include <memory>
+#include <mutex>
 #include <fstream>
+#include <map>
+#include <iostream>
 #include <vector>
 #include <unordered_set>
 #include <unordered_map>
 
+#include "value.h"
 #include "lexer.h"
 #include "AST_Nodes.h"
 #include "parser.h"
+#include "array_buffer.h"
+#include "sparse_array.h"
+#include "array_io.h"
+#include "channel.h"
 #include "ScopedTable.h"
+#include "program_io.h"
+#include "array_kernels.h"
+#include "parallel_sort.h"
+#include "atomics.h"
+#include "tasks.h"
+#include "loop_analysis.h"
 
 ////ABSTRACT SYNTAX TREE////
 
@@ -21,7 +37,7 @@ class DataExtractor : public Visitor
 {
 public:
     Token type;
-    AST_Node *helperNode;
+    std::vector<AST_Node *> *indices; //index expressions of the last array visited
 
     void visit(Bin_OP *ast);
     void visit(Un_OP *ast);
@@ -40,6 +56,23 @@ public:
     void visit(Print *ast);
     void visit(ReadArr *ast);
     void visit(ReadVar *ast);
+    void visit(ArrReduce *ast);
+    void visit(ArrDot *ast);
+    void visit(ArrFill *ast);
+    void visit(ArrCopy *ast);
+    void visit(ArrSort *ast);
+    void visit(ArrSearch *ast);
+    void visit(ArrFile *ast);
+    void visit(ForEach *ast);
+    void visit(ParallelFor *ast);
+    void visit(Reduce *ast);
+    void visit(AtomicOp *ast);
+    void visit(Spawn *ast);
+    void visit(Join *ast);
+    void visit(Yield *ast);
+    void visit(ChanDecl *ast);
+    void visit(Send *ast);
+    void visit(Recv *ast);
     void visit(NO_OP *ast);
 };
 
@@ -65,12 +98,40 @@ public:
     void visit(Print *ast);
     void visit(ReadArr *ast);
     void visit(ReadVar *ast);
+    void visit(ArrReduce *ast);
+    void visit(ArrDot *ast);
+    void visit(ArrFill *ast);
+    void visit(ArrCopy *ast);
+    void visit(ArrSort *ast);
+    void visit(ArrSearch *ast);
+    void visit(ArrFile *ast);
+    void visit(ForEach *ast);
+    void visit(ParallelFor *ast);
+    void visit(Reduce *ast);
+    void visit(AtomicOp *ast);
+    void visit(Spawn *ast);
+    void visit(Join *ast);
+    void visit(Yield *ast);
+    void visit(ChanDecl *ast);
+    void visit(Send *ast);
+    void visit(Recv *ast);
     void visit(NO_OP *ast);
 };
 
+//the tasks a program spawned and the input and output they share with it
+struct TaskGroup
+{
+    TaskScheduler scheduler;
+    std::mutex io_lock;
+    LockedInput input;
+    LockedOutput output;
+
+    TaskGroup(InputSource &in, OutputSink &out);
+};
+
 class Interpreter : public Visitor
 {
-private:
+protected:
     Deleter deleter;
     DataExtractor extractor;
 
@@ -78,18 +139,68 @@ private:
 
     bool skip_mode;
 
-    int value; //used to evaluate expressions
+    value_t value; //used to evaluate expressions
 
-    std::unordered_set<std::string> labels;
+    //labels of the program being run, owned by the interpreter unless the tree was compiled elsewhere
+    std::unordered_set<std::string> own_labels;
+    const std::unordered_set<std::string> *labels;
     std::string looking_for_label;
 
     ScopedTable nested_scopes;
 
+    //WHILE loops the analysis found independent, null when every loop runs sequentially
+    ParallelLoops own_loops;
+    const ParallelLoops *parallel_loops;
+
+    //every instance reads and prints through its own input source and output sink
+    InputSource *in;
+    OutputSink *out;
+
+    value_t read_input();
+
+    //evaluates one index per dimension and returns the flat position of the element in the array
+    long long element_position(const ArrayStorage &arr, const std::vector<AST_Node *> &index_nodes);
+
+    //evaluates the element count of an intrinsic and checks that the array has that many elements
+    long long element_count(const ArrayStorage &arr, AST_Node *count);
+
+    //looks up an array for the built-ins that work on its block of elements, which SPARSE arrays don't have
+    ArrayStorage &dense_array(const std::string &arr_name);
+    //SPARSE arrays are hash tables without locks, so only the scopes that declared one may write to it
+    void store_element(const std::string &arr_name, ArrayStorage &arr, long long position, const value_t &v);
+
+    //PARALLEL FOR and REDUCE run chunks of their range on worker interpreters whose scopes
+    //have this interpreter's scopes as parent
+    bool loop_bounds(AST_Node *from, AST_Node *to, long long &first, long long &last);
+    std::vector<std::pair<long long, long long>> split_range(long long first, long long last);
+    template <class F>
+    void run_chunks(std::size_t count, F task);
+
+    static value_t reduce_combine(Token::type op, const value_t &a, const value_t &b);
+
+    //runs an analyzed WHILE in chunks, false when it is better left to the sequential loop
+    bool run_parallel_loop(const ParallelLoop &plan, int line);
+    //notes why a parallelized loop ran sequentially when a log is attached, returns false for run_parallel_loop
+    //the message is built only then, as name followed by reason
+    bool decline_loop(int line, const std::string &name, const char *reason);
+    std::map<int, std::string> *loop_log = nullptr;
+
+    //created by the first SPAWN. tasks only run while the program waits in JOIN or YIELD,
+    //so they can read its variables through a parent table while it is paused
+    std::unique_ptr<TaskGroup> tasks;
+    void join_tasks();
+
+    //SEND and RECV call it when the channel is full or empty; the program runs a round of its tasks instead
+    //of parking and reports deadlock when none of them could run
+    void wait_for_channel(const std::atomic<std::size_t> &counter, std::size_t seen, const char *deadlock);
+
 public:
     Interpreter();
 
     Interpreter(AST_Node *t);
 
+    Interpreter(AST_Node *t, InputSource &input, OutputSink &output);
+
     void visit(GoTo *ast);
     void visit(Label *ast);
     void visit(BlockCode *ast);
@@ -107,12 +218,38 @@ public:
     void visit(Var *ast);
     void visit(Array *ast);
     void visit(Un_OP *ast);
+    void visit(ArrReduce *ast);
+    void visit(ArrDot *ast);
+    void visit(ArrFill *ast);
+    void visit(ArrCopy *ast);
+    void visit(ArrSort *ast);
+    void visit(ArrSearch *ast);
+    void visit(ArrFile *ast);
+    void visit(ForEach *ast);
+    void visit(ParallelFor *ast);
+    void visit(Reduce *ast);
+    void visit(AtomicOp *ast);
+    void visit(Spawn *ast);
+    void visit(Join *ast);
+    void visit(Yield *ast);
+    void visit(ChanDecl *ast);
+    void visit(Send *ast);
+    void visit(Recv *ast);
     void visit(NO_OP *ast);
 
     void interpret_fullprogram();
+
+    //runs a tree that stays owned by the caller; the scopes are reset first, so one interpreter can run many times.
+    //the loops found by a LoopAnalyzer on the same tree run in parallel
+    void execute(AST_Node *t, const std::unordered_set<std::string> &program_labels, InputSource &input, OutputSink &output,
+                 const ParallelLoops *loops = nullptr);
+
     void interpret_REPL();
+
+    //collects the first reason each parallelized loop ran sequentially at run time, by line
+    void log_loop_fallbacks(std::map<int, std::string> *log);
 };
 
 #include "interpreter.inl"
 
-#endif 
+#endif 
\ No newline at end of file
@@ -11,7 +11,7 @@ inline void DataExtractor::visit(Var *ast)
 inline void DataExtractor::visit(Array *ast)
 {
     type = ast->token;
-    helperNode = ast->index;
+    indices = &ast->indices;
 }
 
 inline void DataExtractor::visit(GoTo *ast)
@@ -37,6 +37,26 @@ inline void DataExtractor::visit(ArrDecl *ast){};
 inline void DataExtractor::visit(Print *ast){};
 inline void DataExtractor::visit(ReadArr *ast){};
 inline void DataExtractor::visit(ReadVar *ast){};
+inline void DataExtractor::visit(ArrReduce *ast){};
+inline void DataExtractor::visit(ArrDot *ast){};
+inline void DataExtractor::visit(ArrFill *ast){};
+inline void DataExtractor::visit(ArrCopy *ast){};
+inline void DataExtractor::visit(ArrSort *ast){};
+inline void DataExtractor::visit(ArrSearch *ast){};
+inline void DataExtractor::visit(ArrFile *ast){};
+inline void DataExtractor::visit(ForEach *ast){};
+inline void DataExtractor::visit(ParallelFor *ast){};
+inline void DataExtractor::visit(Reduce *ast){};
+inline void DataExtractor::visit(AtomicOp *ast){};
+inline void DataExtractor::visit(Spawn *ast)
+{
+    type = ast->token;
+}
+inline void DataExtractor::visit(Join *ast){};
+inline void DataExtractor::visit(Yield *ast){};
+inline void DataExtractor::visit(ChanDecl *ast){};
+inline void DataExtractor::visit(Send *ast){};
+inline void DataExtractor::visit(Recv *ast){};
 inline void DataExtractor::visit(NO_OP *ast){};
 
 //PRE INTERPRETER
@@ -85,23 +105,69 @@ inline void BeforeInterpret::visit(ArrDecl *ast){};
 inline void BeforeInterpret::visit(Print *ast){};
 inline void BeforeInterpret::visit(ReadArr *ast){};
 inline void BeforeInterpret::visit(ReadVar *ast){};
+inline void BeforeInterpret::visit(ArrReduce *ast){};
+inline void BeforeInterpret::visit(ArrDot *ast){};
+inline void BeforeInterpret::visit(ArrFill *ast){};
+inline void BeforeInterpret::visit(ArrCopy *ast){};
+inline void BeforeInterpret::visit(ArrSort *ast){};
+inline void BeforeInterpret::visit(ArrSearch *ast){};
+inline void BeforeInterpret::visit(ArrFile *ast){};
+inline void BeforeInterpret::visit(ForEach *ast)
+{
+    ast->bCode->accept(*this);
+}
+//the parser keeps labels out of PARALLEL FOR bodies
+inline void BeforeInterpret::visit(ParallelFor *ast){};
+inline void BeforeInterpret::visit(Reduce *ast){};
+inline void BeforeInterpret::visit(AtomicOp *ast){};
+inline void BeforeInterpret::visit(Spawn *ast){};
+inline void BeforeInterpret::visit(Join *ast){};
+inline void BeforeInterpret::visit(Yield *ast){};
+inline void BeforeInterpret::visit(ChanDecl *ast){};
+inline void BeforeInterpret::visit(Send *ast){};
+inline void BeforeInterpret::visit(Recv *ast){};
 inline void BeforeInterpret::visit(NO_OP *ast){};
 
 //SYMBOL TABLE
+//TASK GROUP
+
+inline TaskGroup::TaskGroup(InputSource &in, OutputSink &out)
+    : scheduler(ThreadPool::default_size()), input(in, io_lock), output(out, io_lock)
+{
+}
+
 //INTERPRETER
 
-inline Interpreter::Interpreter()
+inline Interpreter::Interpreter() : labels(&own_labels), parallel_loops(nullptr), in(&console_input()), out(&console_output())
 {
     skip_mode = false;
 }
 
-inline Interpreter::Interpreter(AST_Node *t) : tree(t)
+inline Interpreter::Interpreter(AST_Node *t) : tree(t), labels(&own_labels), parallel_loops(&own_loops), in(&console_input()), out(&console_output())
 {
     skip_mode = false;
 
     BeforeInterpret b;
     tree->accept(b);
-    labels = b.labels;
+    own_labels = b.labels;
+
+    LoopAnalyzer analyzer;
+    tree->accept(analyzer);
+    own_loops = analyzer.loops;
+}
+
+inline Interpreter::Interpreter(AST_Node *t, InputSource &input, OutputSink &output)
+    : tree(t), labels(&own_labels), parallel_loops(&own_loops), in(&input), out(&output)
+{
+    skip_mode = false;
+
+    BeforeInterpret b;
+    tree->accept(b);
+    own_labels = b.labels;
+
+    LoopAnalyzer analyzer;
+    tree->accept(analyzer);
+    own_loops = analyzer.loops;
 }
 
 inline void Interpreter::visit(GoTo *ast)
@@ -113,8 +179,8 @@ inline void Interpreter::visit(GoTo *ast)
     ast->accept(extractor);
     std::string goto_label = extractor.type.text_data;
 
-    std::unordered_set<std::string>::const_iterator got = labels.find(goto_label);
-    if (got != labels.end())
+    std::unordered_set<std::string>::const_iterator got = labels->find(goto_label);
+    if (got != labels->end())
     {
 
         looking_for_label = goto_label;
@@ -152,7 +218,7 @@ inline void Interpreter::visit(IfElse *ast)
         return;
 
     ast->expr->accept(*this);
-    int expr = value;
+    value_t expr = value;
 
     nested_scopes.addScope();
     if (expr)
@@ -171,8 +237,15 @@ inline void Interpreter::visit(While *ast)
     if (skip_mode)
         return;
 
+    if (parallel_loops)
+    {
+        ParallelLoops::const_iterator got = parallel_loops->find(ast);
+        if (got != parallel_loops->end() && run_parallel_loop(got->second, ast->line))
+            return;
+    }
+
     ast->expr->accept(*this);
-    int expr = value;
+    value_t expr = value;
 
     while (expr)
     {
@@ -205,10 +278,16 @@ inline void Interpreter::visit(ArrDecl *ast)
 
     ast->arr->accept(extractor);
     std::string arrname = extractor.type.text_data;
+    std::vector<AST_Node *> &size_nodes = *extractor.indices;
 
-    extractor.helperNode->accept(*this);
+    std::vector<value_t> sizes(size_nodes.size());
+    for (int i = 0; i < size_nodes.size(); ++i)
+    {
+        size_nodes[i]->accept(*this);
+        sizes[i] = value;
+    }
 
-    nested_scopes.dec_arr(arrname, value);
+    nested_scopes.dec_arr(arrname, sizes, ast->storage.t, ast->storage.text_data);
 }
 
 inline void Interpreter::visit(VarAssign *ast)
@@ -231,31 +310,72 @@ inline void Interpreter::visit(ArrAssign *ast)
 
     ast->arr->accept(extractor);
     std::string arrname = extractor.type.text_data;
+    std::vector<AST_Node *> &index_nodes = *extractor.indices;
 
     ast->expr->accept(*this);
-    int data = value;
+    value_t data = value;
 
-    extractor.helperNode->accept(*this);
-    int index = value;
-
-    nested_scopes.modify_arr(arrname, index, data);
+    ArrayStorage &arr = nested_scopes.lookup_arr(arrname);
+    store_element(arrname, arr, element_position(arr, index_nodes), data);
 }
 
-inline void Interpreter::visit(ReadVar *ast)
+//reads one line and evaluates it; plain integers skip the lexer and parser
+inline value_t Interpreter::read_input()
 {
-    if (skip_mode)
-        return;
-
     std::string input;
+    if (!in->read_line(input))
+        throw std::invalid_argument("no more input");
 
-    std::cout << "> ";
-    getline(std::cin, input);
+    std::size_t pos = input.find_first_not_of(" \t\r");
+    std::size_t end = input.find_last_not_of(" \t\r");
+    if (pos != std::string::npos)
+    {
+        bool negative = input[pos] == '-';
+        std::size_t digits = negative ? pos + 1 : pos;
+        if (digits <= end && input.find_first_not_of("0123456789", digits) > end)
+            return value_from_digits(input.data() + digits, input.data() + end + 1, negative);
+    }
 
     Lexer inputLex(input);
     Parser inputParse(inputLex);
+    AST_Node *expr = inputParse.Expression();
 
-    inputParse.Expression()->accept(*this);
-    int inputValue = value;
+    try
+    {
+        expr->accept(*this);
+    }
+    catch (...)
+    {
+        expr->accept(deleter);
+        throw;
+    }
+    expr->accept(deleter);
+
+    return value;
+}
+
+//index expressions cannot declare arrays, so arr stays valid while they are evaluated
+inline long long Interpreter::element_position(const ArrayStorage &arr, const std::vector<AST_Node *> &index_nodes)
+{
+    if (index_nodes.size() != arr.dims.size())
+        throw std::invalid_argument("wrong number of indices for the array");
+
+    long long position = 0;
+    for (int i = 0; i < index_nodes.size(); ++i)
+    {
+        index_nodes[i]->accept(*this);
+        position += arr.offset(i, value);
+    }
+
+    return position;
+}
+
+inline void Interpreter::visit(ReadVar *ast)
+{
+    if (skip_mode)
+        return;
+
+    value_t inputValue = read_input();
 
     ast->var->accept(extractor);
     std::string varname = extractor.type.text_data;
@@ -268,24 +388,14 @@ inline void Interpreter::visit(ReadArr *ast)
     if (skip_mode)
         return;
 
-    std::string input;
-    std::cout << "> ";
-    getline(std::cin, input);
-
-    Lexer inputLex(input);
-    Parser inputParse(inputLex);
-
-    inputParse.Expression()->accept(*this);
-    int inputValue = value;
+    value_t inputValue = read_input();
     //cout << "the value of entered expression is" << inputValue << endl;
 
     ast->arr->accept(extractor);
     std::string arrname = extractor.type.text_data;
 
-    extractor.helperNode->accept(*this);
-    int index = value;
-
-    nested_scopes.modify_arr(arrname, index, inputValue);
+    ArrayStorage &arr = nested_scopes.lookup_arr(arrname);
+    store_element(arrname, arr, element_position(arr, *extractor.indices), inputValue);
 }
 
 inline void Interpreter::visit(Print *ast)
@@ -295,12 +405,12 @@ inline void Interpreter::visit(Print *ast)
 
     ast->expr_to_print->accept(*this);
 
-    std::cout << value << std::endl;
+    out->write_value(value);
 }
 
 inline void Interpreter::visit(Bin_OP *ast)
 {
-    int v1, v2;
+    value_t v1, v2;
     ast->left->accept(*this); //update value
     v1 = value;
     ast->right->accept(*this);
@@ -309,21 +419,19 @@ inline void Interpreter::visit(Bin_OP *ast)
     switch (ast->op.t)
     {
     case Token::PLUS:
-        value = v1 + v2;
+        value = value_add(v1, v2);
         break;
     case Token::MINUS:
-        value = v1 - v2;
+        value = value_sub(v1, v2);
         break;
     case Token::MUL:
-        value = v1 * v2;
+        value = value_mul(v1, v2);
         break;
     case Token::DIV:
-        if (v2 == 0)
-            throw std::invalid_argument("cant divide by zero!");
-        value = v1 / v2;
+        value = value_div(v1, v2);
         break;
     case Token::MOD:
-        value = v1 % v2;
+        value = value_mod(v1, v2);
         break;
     case Token::EQ:
         value = v1 == v2;
@@ -368,10 +476,9 @@ inline void Interpreter::visit(Array *ast)
 {
     std::string arr_name = ast->token.text_data;
 
-    ast->index->accept(*this);
-    int index = value;
-
-    value = nested_scopes.lookup_arr(arr_name, index);
+    const ArrayStorage &arr = nested_scopes.lookup_arr(arr_name);
+    long long position = element_position(arr, ast->indices);
+    value = arr.sparse ? arr.elements.get(position) : arr.data[position];
 }
 
 inline void Interpreter::visit(Un_OP *ast)
@@ -384,26 +491,684 @@ inline void Interpreter::visit(Un_OP *ast)
         value = !value;
         break;
     case Token::MINUS:
-        value = -value;
+        value = value_neg(value);
         break;
     }
 }
 
+inline long long Interpreter::element_count(const ArrayStorage &arr, AST_Node *count)
+{
+    count->accept(*this);
+
+    long long n;
+    if (!value_fits_long(value, n) || n < 0 || n > arr.size())
+        throw std::invalid_argument("element count is outside the array");
+
+    return n;
+}
+
+inline ArrayStorage &Interpreter::dense_array(const std::string &arr_name)
+{
+    ArrayStorage &arr = nested_scopes.lookup_arr(arr_name);
+    if (arr.sparse)
+        throw std::invalid_argument("SPARSE arrays only work with SUM, MAX, MIN and FOR IN");
+
+    return arr;
+}
+
+inline void Interpreter::store_element(const std::string &arr_name, ArrayStorage &arr, long long position, const value_t &v)
+{
+    if (!arr.sparse)
+    {
+        arr.data[position] = v;
+        return;
+    }
+
+    if (nested_scopes.arr_is_shared(arr_name))
+        throw std::invalid_argument("PARALLEL FOR bodies and tasks cannot write SPARSE arrays declared outside them");
+
+    arr.elements.set(position, v);
+}
+
+inline void Interpreter::visit(ArrReduce *ast)
+{
+    const ArrayStorage &arr = nested_scopes.lookup_arr(ast->arr.text_data);
+    long long n = element_count(arr, ast->count);
+
+    if (ast->op.t != Token::SUM && n == 0)
+        throw std::invalid_argument("MAX and MIN need at least one element");
+
+    //a SPARSE array folds its entries below n, plus one of its zeros when not all of the n elements are entries
+    if (arr.sparse)
+    {
+        long long present = 0;
+        value_t result = 0;
+        arr.elements.for_each([&](long long position, const value_t &v) {
+            if (position < n)
+                result = present++ ? reduce_combine(ast->op.t, result, v) : v;
+        });
+
+        value = present < n && present ? reduce_combine(ast->op.t, result, 0) : result;
+        return;
+    }
+
+    //a mapped array starts reading ahead over the whole scan, the other built-ins do the same
+    arr.data.will_scan(n);
+
+    switch (ast->op.t)
+    {
+    case Token::SUM:
+        value = array_sum(arr.data.data(), n);
+        break;
+    case Token::MAX:
+        value = array_max(arr.data.data(), n);
+        break;
+    case Token::MIN:
+        value = array_min(arr.data.data(), n);
+        break;
+    }
+}
+
+inline void Interpreter::visit(ArrDot *ast)
+{
+    const ArrayStorage &left = dense_array(ast->left.text_data);
+    const ArrayStorage &right = dense_array(ast->right.text_data);
+
+    long long n = element_count(left.data.size() < right.data.size() ? left : right, ast->count);
+    left.data.will_scan(n);
+    right.data.will_scan(n);
+
+    value = array_dot(left.data.data(), right.data.data(), n);
+}
+
+inline void Interpreter::visit(ArrFill *ast)
+{
+    if (skip_mode)
+        return;
+
+    ast->expr->accept(*this);
+
+    ArrayStorage &arr = dense_array(ast->arr.text_data);
+    arr.data.will_scan(arr.data.size());
+    array_fill(arr.data.data(), (long long)arr.data.size(), value);
+}
+
+inline void Interpreter::visit(ArrCopy *ast)
+{
+    if (skip_mode)
+        return;
+
+    const ArrayStorage &from = dense_array(ast->from.text_data);
+    ArrayStorage &to = dense_array(ast->to.text_data);
+
+    if (to.data.size() < from.data.size())
+        throw std::invalid_argument("COPY target is smaller than the source");
+
+    from.data.will_scan(from.data.size());
+
+    array_copy(from.data.data(), (long long)from.data.size(), to.data.data());
+}
+
+inline void Interpreter::visit(ArrSort *ast)
+{
+    if (skip_mode)
+        return;
+
+    ArrayStorage &arr = dense_array(ast->arr.text_data);
+    long long n = element_count(arr, ast->count);
+    arr.data.will_scan(n);
+
+    parallel_sort(arr.data.data(), n, ThreadPool::shared());
+}
+
+inline void Interpreter::visit(ArrSearch *ast)
+{
+    const ArrayStorage &arr = dense_array(ast->arr.text_data);
+    long long n = element_count(arr, ast->count);
+
+    ast->key->accept(*this);
+
+    value = value_from_long(sorted_search(arr.data.data(), n, value));
+}
+
+//the file goes straight into or out of the array's own storage, which may be a MAP file itself.
+//storing a whole MAP array into its own file only writes its pages back
+inline void Interpreter::visit(ArrFile *ast)
+{
+    if (skip_mode)
+        return;
+
+    ArrayStorage &arr = dense_array(ast->arr.text_data);
+    long long n = ast->count ? element_count(arr, ast->count) : -1;
+
+    if (ast->op.t == Token::LOAD)
+        load_array(ast->file.text_data, ast->text, arr.data.data(), arr.data.size(), n);
+    else if (!ast->text && (n < 0 || (std::size_t)n == arr.data.size()) && arr.data.maps(ast->file.text_data))
+        arr.data.sync();
+    else
+        store_array(ast->file.text_data, ast->text, arr.data.data(), n < 0 ? arr.data.size() : n);
+}
+
+//the entries are collected first, so the body can change the array while the loop runs.
+//a GOTO out of the body ends the loop
+inline void Interpreter::visit(ForEach *ast)
+{
+    if (skip_mode)
+        return;
+
+    const ArrayStorage &arr = nested_scopes.lookup_arr(ast->arr.text_data);
+
+    std::vector<std::pair<long long, value_t>> entries;
+    if (arr.sparse)
+        entries = arr.elements.entries();
+    else
+    {
+        for (std::size_t i = 0; i < arr.data.size(); ++i)
+        {
+            if (!arr.data[i])
+                continue;
+            entries.emplace_back(i, arr.data[i]);
+        }
+    }
+
+    std::string key = ast->key.text_data;
+    std::string val = ast->val.text_data;
+
+    nested_scopes.addScope();
+    nested_scopes.dec_var(key);
+    nested_scopes.dec_var(val);
+
+    for (std::size_t i = 0; i < entries.size() && !skip_mode; ++i)
+    {
+        nested_scopes.modify_var(key, value_from_long(entries[i].first));
+        nested_scopes.modify_var(val, entries[i].second);
+
+        nested_scopes.addScope();
+        ast->bCode->accept(*this);
+        nested_scopes.removeScope();
+    }
+
+    nested_scopes.removeScope();
+}
+
+inline bool Interpreter::loop_bounds(AST_Node *from, AST_Node *to, long long &first, long long &last)
+{
+    from->accept(*this);
+    if (!value_fits_long(value, first))
+        throw std::invalid_argument("invalid loop bounds");
+    to->accept(*this);
+    if (!value_fits_long(value, last))
+        throw std::invalid_argument("invalid loop bounds");
+
+    return first <= last;
+}
+
+//a few chunks per worker leaves room for stealing when iterations take uneven time
+inline std::vector<std::pair<long long, long long>> Interpreter::split_range(long long first, long long last)
+{
+    unsigned long long count = (unsigned long long)last - (unsigned long long)first + 1;
+    long long chunk = std::max(1ull, count / (ThreadPool::shared().size() * 4));
+
+    std::vector<std::pair<long long, long long>> ranges;
+    for (long long start = first;; start += chunk)
+    {
+        long long end = last - start < chunk ? last : start + chunk - 1;
+        ranges.push_back({start, end});
+
+        if (end == last)
+            break;
+    }
+
+    return ranges;
+}
+
+//every chunk uses this interpreter's tables, so all of them finish before the first error in loop order is rethrown
+template <class F>
+inline void Interpreter::run_chunks(std::size_t count, F task)
+{
+    ThreadPool &pool = ThreadPool::shared();
+
+    std::vector<std::future<void>> chunks;
+    for (std::size_t i = 0; i < count; ++i)
+        chunks.push_back(pool.submit([&task, i]() { task(i); }));
+
+    std::exception_ptr error;
+    for (int i = 0; i < chunks.size(); ++i)
+    {
+        try
+        {
+            pool.wait(chunks[i]);
+        }
+        catch (...)
+        {
+            if (!error)
+                error = std::current_exception();
+        }
+    }
+
+    if (error)
+        std::rethrow_exception(error);
+}
+
+inline void Interpreter::visit(ParallelFor *ast)
+{
+    if (skip_mode)
+        return;
+
+    long long first, last;
+    if (!loop_bounds(ast->from, ast->to, first, last))
+        return;
+
+    std::vector<std::pair<long long, long long>> ranges = split_range(first, last);
+
+    run_chunks(ranges.size(), [this, ast, &ranges](std::size_t chunk) {
+        Interpreter worker;
+        worker.nested_scopes.set_parent(&nested_scopes);
+        worker.nested_scopes.dec_var(ast->var.text_data);
+
+        for (long long i = ranges[chunk].first; i <= ranges[chunk].second; ++i)
+        {
+            worker.nested_scopes.modify_var(ast->var.text_data, value_from_long(i));
+
+            worker.nested_scopes.addScope();
+            ast->bCode->accept(worker);
+            worker.nested_scopes.removeScope();
+        }
+    });
+}
+
+inline value_t Interpreter::reduce_combine(Token::type op, const value_t &a, const value_t &b)
+{
+    switch (op)
+    {
+    case Token::SUM:
+        return value_add(a, b);
+    case Token::MIN:
+        return b < a ? b : a;
+    default:
+        return a < b ? b : a;
+    }
+}
+
+//every chunk folds its own iterations, the partials are then folded into the target in loop order
+inline void Interpreter::visit(Reduce *ast)
+{
+    if (skip_mode)
+        return;
+
+    //read first so a missing target is reported before any work is done
+    value_t result = nested_scopes.lookup_var(ast->target.text_data);
+
+    long long first, last;
+    if (!loop_bounds(ast->from, ast->to, first, last))
+        return;
+
+    std::vector<std::pair<long long, long long>> ranges = split_range(first, last);
+    std::vector<value_t> partials(ranges.size());
+
+    run_chunks(ranges.size(), [this, ast, &ranges, &partials](std::size_t chunk) {
+        Interpreter worker;
+        worker.nested_scopes.set_parent(&nested_scopes);
+        worker.nested_scopes.dec_var(ast->var.text_data);
+
+        for (long long i = ranges[chunk].first; i <= ranges[chunk].second; ++i)
+        {
+            worker.nested_scopes.modify_var(ast->var.text_data, value_from_long(i));
+            ast->expr->accept(worker);
+
+            if (i == ranges[chunk].first)
+                partials[chunk] = worker.value;
+            else
+                partials[chunk] = reduce_combine(ast->op.t, partials[chunk], worker.value);
+        }
+    });
+
+    for (int i = 0; i < partials.size(); ++i)
+        result = reduce_combine(ast->op.t, result, partials[i]);
+
+    nested_scopes.modify_var(ast->target.text_data, result);
+}
+
+//the operands are evaluated first, only the update of the element itself is atomic
+inline void Interpreter::visit(AtomicOp *ast)
+{
+    if (skip_mode)
+        return;
+
+    ast->arr->accept(extractor);
+    std::string arrname = extractor.type.text_data;
+    std::vector<AST_Node *> &index_nodes = *extractor.indices;
+
+    ast->expr->accept(*this);
+    value_t operand = value;
+
+    value_t desired = 0;
+    if (ast->desired)
+    {
+        ast->desired->accept(*this);
+        desired = value;
+    }
+
+    ArrayStorage &arr = nested_scopes.lookup_arr(arrname);
+    long long position = element_position(arr, index_nodes);
+
+    //a SPARSE element is updated on a copy that is stored back, only one thread can write the array
+    value_t element = arr.sparse ? arr.elements.get(position) : value_t(0);
+    value_t &slot = arr.sparse ? element : arr.data[position];
+
+    bool swapped = false;
+    switch (ast->op.t)
+    {
+    case Token::ADD:
+        atomic_add(slot, operand);
+        break;
+    case Token::MIN:
+        atomic_min(slot, operand);
+        break;
+    case Token::MAX:
+        atomic_max(slot, operand);
+        break;
+    default:
+        swapped = atomic_cas(slot, operand, desired);
+    }
+
+    if (arr.sparse)
+        store_element(arrname, arr, position, element);
+    if (ast->op.t == Token::CAS)
+        nested_scopes.modify_var(ast->result.text_data, value_from_long(swapped ? 1 : 0));
+}
+
+//a task is an interpreter with its own scopes that looks for the label like a GOTO does and then runs to the end
+inline void Interpreter::visit(Spawn *ast)
+{
+    if (skip_mode)
+        return;
+
+    if (TaskScheduler::inside_task())
+        throw std::invalid_argument("only the program itself can SPAWN and JOIN tasks");
+
+    std::string label = ast->token.text_data;
+    if (labels->find(label) == labels->end())
+        throw std::invalid_argument("no such label in program!");
+
+    std::string var = ast->var.text_data;
+    value_t argument = 0;
+    if (ast->expr)
+    {
+        ast->expr->accept(*this);
+        argument = value;
+    }
+
+    if (!tasks)
+        tasks.reset(new TaskGroup(*in, *out));
+
+    AST_Node *program = tree;
+    tasks->scheduler.spawn([this, program, label, var, argument]() {
+        Interpreter task;
+        task.tree = program;
+        task.labels = labels;
+        task.in = &tasks->input;
+        task.out = &tasks->output;
+        task.nested_scopes.set_parent(&nested_scopes);
+
+        if (!var.empty())
+        {
+            task.nested_scopes.dec_var(var);
+            task.nested_scopes.modify_var(var, argument);
+        }
+
+        task.skip_mode = true;
+        task.looking_for_label = label;
+        program->accept(task);
+    });
+}
+
+inline void Interpreter::visit(Join *ast)
+{
+    if (skip_mode)
+        return;
+
+    if (TaskScheduler::inside_task())
+        throw std::invalid_argument("only the program itself can SPAWN and JOIN tasks");
+
+    join_tasks();
+}
+
+inline void Interpreter::visit(Yield *ast)
+{
+    if (skip_mode)
+        return;
+
+    if (TaskScheduler::inside_task())
+        TaskScheduler::yield();
+    else if (tasks)
+        tasks->scheduler.run_round();
+}
+
+inline void Interpreter::join_tasks()
+{
+    if (tasks)
+        tasks->scheduler.run_all();
+}
+
+inline void Interpreter::visit(ChanDecl *ast)
+{
+    if (skip_mode)
+        return;
+
+    ast->capacity->accept(*this);
+
+    long long capacity;
+    if (!value_fits_long(value, capacity) || capacity < 1)
+        throw std::invalid_argument("invalid channel capacity");
+
+    nested_scopes.dec_chan(ast->chan.text_data, capacity);
+}
+
+inline void Interpreter::wait_for_channel(const std::atomic<std::size_t> &counter, std::size_t seen, const char *deadlock)
+{
+    if (TaskScheduler::inside_task())
+        TaskScheduler::park(counter, seen);
+    else if (!tasks || !tasks->scheduler.run_round())
+        throw std::invalid_argument(deadlock);
+}
+
+//the counter of the other side is read before trying, so a change in between wakes the task right away.
+//the channel is held while the task waits, its scope may be gone by then
+inline void Interpreter::visit(Send *ast)
+{
+    if (skip_mode)
+        return;
+
+    std::shared_ptr<Channel> chan = nested_scopes.lookup_chan(ast->chan.text_data);
+
+    ast->expr->accept(*this);
+    value_t sent = value;
+
+    while (true)
+    {
+        std::size_t seen = chan->received().load();
+        if (chan->try_send(sent))
+            break;
+
+        wait_for_channel(chan->received(), seen, "SEND to a full channel would wait forever");
+    }
+
+    TaskScheduler::notify();
+}
+
+//the value is stored like READ stores its input
+inline void Interpreter::visit(Recv *ast)
+{
+    if (skip_mode)
+        return;
+
+    std::shared_ptr<Channel> chan = nested_scopes.lookup_chan(ast->chan.text_data);
+
+    value_t received;
+    while (true)
+    {
+        std::size_t seen = chan->sent().load();
+        if (chan->try_recv(received))
+            break;
+
+        wait_for_channel(chan->sent(), seen, "RECV from an empty channel would wait forever");
+    }
+
+    TaskScheduler::notify();
+
+    if (ast->var)
+    {
+        ast->var->accept(extractor);
+        nested_scopes.modify_var(extractor.type.text_data, received);
+    }
+    else
+    {
+        ast->arr->accept(extractor);
+        std::string arrname = extractor.type.text_data;
+
+        ArrayStorage &arr = nested_scopes.lookup_arr(arrname);
+        store_element(arrname, arr, element_position(arr, *extractor.indices), received);
+    }
+}
+
+//the workers run the iterations like a PARALLEL FOR; the private variables get a copy per worker and
+//the copies of the chunk holding the last iteration are written back, then i gets its value after the loop
+inline bool Interpreter::decline_loop(int line, const std::string &name, const char *reason)
+{
+    if (loop_log)
+        loop_log->insert({line, name + reason});
+    return false;
+}
+
+inline void Interpreter::log_loop_fallbacks(std::map<int, std::string> *log)
+{
+    loop_log = log;
+}
+
+inline bool Interpreter::run_parallel_loop(const ParallelLoop &plan, int line)
+{
+    std::size_t workers = ThreadPool::shared().size();
+    if (workers < 2)
+        return decline_loop(line, std::string(), "there is only one worker thread");
+
+    //the sequential loop reports the errors of odd bounds and values that aren't whole numbers
+    long long first, bound;
+    if (!value_fits_long(nested_scopes.lookup_var(plan.var), first))
+        return decline_loop(line, plan.var, " is not a whole number");
+    plan.bound->accept(*this);
+    if (!value_fits_long(value, bound))
+        return decline_loop(line, std::string(), "the bound is not a whole number");
+
+    if (!plan.inclusive && bound == LLONG_MIN)
+        return decline_loop(line, std::string(), "the loop has no iterations");
+    long long last = plan.inclusive ? bound : bound - 1;
+    if (first > last || last == LLONG_MAX || (unsigned long long)last - (unsigned long long)first < 2 * workers)
+        return decline_loop(line, std::string(), "too few iterations for the workers");
+
+    //the workers would not see a variable or array of the same name declared outside the loop
+    for (int i = 0; i < plan.local_vars.size(); ++i)
+        if (nested_scopes.var_exists(plan.local_vars[i]))
+            return decline_loop(line, plan.local_vars[i], " is declared outside the loop as well");
+    for (int i = 0; i < plan.local_arrays.size(); ++i)
+        if (nested_scopes.arr_exists(plan.local_arrays[i]))
+            return decline_loop(line, plan.local_arrays[i], " is declared outside the loop as well");
+    //the workers could not write a SPARSE array of the program
+    for (int i = 0; i < plan.written_arrays.size(); ++i)
+        if (nested_scopes.arr_exists(plan.written_arrays[i]) && nested_scopes.lookup_arr(plan.written_arrays[i]).sparse)
+            return decline_loop(line, plan.written_arrays[i], " is a SPARSE array");
+
+    std::vector<bool> write_back(plan.private_vars.size());
+    for (int i = 0; i < plan.private_vars.size(); ++i)
+    {
+        write_back[i] = nested_scopes.var_exists(plan.private_vars[i]);
+        if (!write_back[i] && !plan.declared_vars.count(plan.private_vars[i]))
+            return decline_loop(line, plan.private_vars[i], " is not declared");
+    }
+
+    std::vector<std::pair<long long, long long>> ranges = split_range(first, last);
+    std::vector<value_t> last_values(plan.private_vars.size());
+    std::vector<AST_Node *> &statements = plan.body->statements;
+
+    run_chunks(ranges.size(), [this, &plan, &ranges, &last_values, &statements](std::size_t chunk) {
+        Interpreter worker;
+        worker.nested_scopes.set_parent(&nested_scopes);
+        worker.nested_scopes.dec_var(plan.var);
+        for (int i = 0; i < plan.private_vars.size(); ++i)
+            worker.nested_scopes.dec_var(plan.private_vars[i]);
+
+        for (long long i = ranges[chunk].first; i <= ranges[chunk].second; ++i)
+        {
+            worker.nested_scopes.modify_var(plan.var, value_from_long(i));
+
+            worker.nested_scopes.addScope();
+            for (int k = 0; k < statements.size(); ++k)
+                if (statements[k] != plan.step)
+                    statements[k]->accept(worker);
+            worker.nested_scopes.removeScope();
+        }
+
+        if (chunk + 1 == ranges.size())
+            for (int i = 0; i < plan.private_vars.size(); ++i)
+                last_values[i] = worker.nested_scopes.lookup_var(plan.private_vars[i]);
+    });
+
+    for (int i = 0; i < plan.private_vars.size(); ++i)
+        if (write_back[i])
+            nested_scopes.modify_var(plan.private_vars[i], last_values[i]);
+
+    nested_scopes.modify_var(plan.var, value_from_long(last + 1));
+    return true;
+}
+
 inline void Interpreter::visit(NO_OP *ast)
 {
     return;
 }
 
+//the program ends once the tasks it left running finished too
 inline void Interpreter::interpret_fullprogram()
 {
     tree->accept(*this);
+    join_tasks();
     tree->accept(deleter);
+    out->flush();
+}
+
+inline void Interpreter::execute(AST_Node *t, const std::unordered_set<std::string> &program_labels, InputSource &input, OutputSink &output,
+                                 const ParallelLoops *loops)
+{
+    tree = t;
+    labels = &program_labels;
+    parallel_loops = loops;
+    in = &input;
+    out = &output;
+
+    skip_mode = false;
+    looking_for_label = "";
+    tasks.reset();
+    nested_scopes.clear();
+
+    //tasks left behind by an error are cancelled now, they use this run's input and output
+    try
+    {
+        tree->accept(*this);
+        join_tasks();
+    }
+    catch (...)
+    {
+        tasks.reset();
+        throw;
+    }
+    out->flush();
 }
+
 inline void Interpreter::interpret_REPL()
 {
     std::string input;
-    std::cout << ">";
-    getline(std::cin, input);
+    ConsoleInput repl_prompt(">");
+    if (!repl_prompt.read_line(input))
+        throw std::invalid_argument("end");
 
     if (input != "stop")
     {
@@ -6,7 +6,7 @@
 struct Token
 {
     //value is diffrent than -1 only when the token is for integer
-    int value;
+    value_t value;
 
     enum type
     {
@@ -21,12 +21,42 @@ struct Token
         ELSE,
         WHILE,
         DONE,
+        FILL,
+        COPY,
+        TO,
+        SUM,
+        MAX,
+        MIN,
+        DOT,
+        SORT,
+        BSEARCH,
+        PARALLEL,
+        FOR,
+        REDUCE,
+        ATOMIC,
+        ADD,
+        CAS,
+        SPAWN,
+        JOIN,
+        YIELD,
+        CHAN,
+        SEND,
+        RECV,
+        MAP,
+        LOAD,
+        STORE,
+        FROM,
+        TEXT,
+        SPARSE,
+        IN,
 
         //extra types that are needed
         SQ_LPAREN,
         SQ_RPAREN,
+        COMMA,
 
         ID,
+        STRING, //a quoted file name, the text without the quotes is in text_data
         ASSIGN,
         NEWLINE,
 
@@ -42,7 +72,7 @@ struct Token
         NOT,
 
         //arithmetic types
-        INTEGER,
+        INTEGER, //any number literal, decimals are only accepted by BASIC_NANBOX builds
         PLUS,
         MINUS,
         MUL,
@@ -55,9 +85,14 @@ struct Token
 
     //text_data contains text only when the token is ID
     std::string text_data;
+
+    //position of the first character of the token in the source, both start from 1
+    int line = 0;
+    int column = 0;
 };
 
-std::unordered_map<std::string, Token> RESERVED_KEYWORDS =
+//read only after construction, so any number of lexers can share it across threads
+static const std::unordered_map<std::string, Token> RESERVED_KEYWORDS =
     {{"LABEL", Token{-1, Token::LABEL}},
      {"GOTO", Token{-1, Token::GOTO}},
      {"LET", Token{-1, Token::LET}},
@@ -67,7 +102,35 @@ std::unordered_map<std::string, Token> RESERVED_KEYWORDS =
      {"ENDIF", Token{-1, Token::ENDIF}},
      {"ELSE", Token{-1, Token::ELSE}},
      {"WHILE", Token{-1, Token::WHILE}},
-     {"DONE", Token{-1, Token::DONE}}};
+     {"DONE", Token{-1, Token::DONE}},
+     {"FILL", Token{-1, Token::FILL}},
+     {"COPY", Token{-1, Token::COPY}},
+     {"TO", Token{-1, Token::TO}},
+     {"SUM", Token{-1, Token::SUM}},
+     {"MAX", Token{-1, Token::MAX}},
+     {"MIN", Token{-1, Token::MIN}},
+     {"DOT", Token{-1, Token::DOT}},
+     {"SORT", Token{-1, Token::SORT}},
+     {"BSEARCH", Token{-1, Token::BSEARCH}},
+     {"PARALLEL", Token{-1, Token::PARALLEL}},
+     {"FOR", Token{-1, Token::FOR}},
+     {"REDUCE", Token{-1, Token::REDUCE}},
+     {"ATOMIC", Token{-1, Token::ATOMIC}},
+     {"ADD", Token{-1, Token::ADD}},
+     {"CAS", Token{-1, Token::CAS}},
+     {"SPAWN", Token{-1, Token::SPAWN}},
+     {"JOIN", Token{-1, Token::JOIN}},
+     {"YIELD", Token{-1, Token::YIELD}},
+     {"CHAN", Token{-1, Token::CHAN}},
+     {"SEND", Token{-1, Token::SEND}},
+     {"RECV", Token{-1, Token::RECV}},
+     {"MAP", Token{-1, Token::MAP}},
+     {"LOAD", Token{-1, Token::LOAD}},
+     {"STORE", Token{-1, Token::STORE}},
+     {"FROM", Token{-1, Token::FROM}},
+     {"TEXT", Token{-1, Token::TEXT}},
+     {"SPARSE", Token{-1, Token::SPARSE}},
+     {"IN", Token{-1, Token::IN}}};
 
 class Lexer
 {
@@ -77,6 +140,10 @@ private:
     int pos;
     char current_char;
 
+    int line;
+    int line_start; //pos of the first character of the current line
+    int token_line, token_column;
+
     void advance();
     char peek();
 
@@ -84,6 +151,8 @@ private:
     //pre-constructed token for that reserved keyword is returned, otherwise we make an identifier token
     Token _id();
     Token integer();
+    Token string();
+    Token scan_token();
 
     void error();
     void skip_whitespace();
@@ -1,7 +1,7 @@
 #ifndef LEXER_SOURCE
 #define LEXER_SOURCE
 
-inline Lexer::Lexer(const std::string &input) : text(input), pos(0)
+inline Lexer::Lexer(const std::string &input) : text(input), pos(0), line(1), line_start(0), token_line(1), token_column(1)
 {
     current_char = text[pos];
 }
@@ -13,6 +13,12 @@ inline void Lexer::error()
 
 inline void Lexer::advance()
 {
+    if (current_char == '\n')
+    {
+        ++line;
+        line_start = pos + 1;
+    }
+
     pos += 1;
     if (pos < text.length())
         current_char = text[pos];
@@ -38,17 +44,44 @@ inline char Lexer::peek()
 
 inline Token Lexer::integer()
 {
-    int result = 0;
-
+    int start = pos;
     while (current_char && isdigit(current_char))
+        advance();
+
+    value_t result = value_from_digits(text.data() + start, text.data() + pos);
+
+    //a decimal literal is converted as a whole so it is rounded only once
+    if (current_char == '.' && isdigit(peek()))
     {
-        result = result * 10 + (int)(current_char - '0');
         advance();
+        while (current_char && isdigit(current_char))
+            advance();
+
+        result = value_from_decimal(text.substr(start, pos - start));
     }
 
     return Token{result, Token::INTEGER};
 }
 
+//everything up to the closing quote on the same line, there are no escapes
+inline Token Lexer::string()
+{
+    advance();
+
+    std::string result;
+    while (current_char && current_char != '"' && current_char != '\n')
+    {
+        result.push_back(current_char);
+        advance();
+    }
+
+    if (current_char != '"')
+        error();
+    advance();
+
+    return Token{-1, Token::STRING, result};
+}
+
 inline Token Lexer::_id()
 {
     std::string result;
@@ -68,6 +101,15 @@ inline Token Lexer::_id()
 }
 
 inline Token Lexer::get_next_token()
+{
+    Token token = scan_token();
+    token.line = token_line;
+    token.column = token_column;
+
+    return token;
+}
+
+inline Token Lexer::scan_token()
 {
     while (current_char)
     {
@@ -79,12 +121,18 @@ inline Token Lexer::get_next_token()
                 continue;
         }
 
+        token_line = line;
+        token_column = pos - line_start + 1;
+
         if (isalpha(current_char))
             return _id();
 
         if (isdigit(current_char))
             return integer();
 
+        if (current_char == '"')
+            return string();
+
         if (current_char == '=' && peek() == '=')
         {
             advance();
@@ -197,6 +245,12 @@ inline Token Lexer::get_next_token()
             advance();
             return Token{-1, Token::RPAREN};
         }
+        if (current_char == ',')
+        {
+            advance();
+            return Token{-1, Token::COMMA};
+        }
+
         if (current_char == '[')
         {
             advance();
@@ -211,6 +265,8 @@ inline Token Lexer::get_next_token()
         error();
     }
 
+    token_line = line;
+    token_column = pos - line_start + 1;
     return Token{-1, Token::END};
 }
 
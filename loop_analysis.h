@@ -0,0 +1,179 @@
+#pragma once
+
+#ifndef LOOP_ANALYSIS_HEADER
+#define LOOP_ANALYSIS_HEADER
+
+#include <climits>
+#include <ostream>
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include <unordered_set>
+
+////LOOP ANALYSIS////
+//finds WHILE loops whose iterations are independent, so the interpreter can run them like a PARALLEL FOR.
+//a loop qualifies when it has the shape
+//    WHILE i < bound (or i <= bound)
+//        ...
+//        i = i + 1
+//    DONE
+//the bound does not change inside the loop, the body has no READ, PRINT, GOTO, LABEL or task and channel statements,
+//every array written in the body is accessed only at [i + c] in its first dimension with one constant c
+//or only through one of ATOMIC ADD, MIN or MAX, which give the same result in any order,
+//and every other variable assigned in the body is assigned before it is read in each iteration
+
+//one access to an array inside a loop body, indices is null when the built-in uses the whole array
+struct ArrayAccess
+{
+    std::string name;
+    const std::vector<AST_Node *> *indices;
+    bool write;
+    const AtomicOp *atomic; //set when the access is an ATOMIC statement
+};
+
+//what a statement or expression does to the variables and arrays around it
+class LoopScanner : public Visitor
+{
+public:
+    std::string forbidden; //the first statement that cannot run in parallel, empty if none
+
+    std::unordered_set<std::string> reads;
+    std::unordered_set<std::string> writes;
+    std::unordered_set<std::string> declared_vars;
+    std::unordered_set<std::string> declared_arrays;
+    std::unordered_set<std::string> loop_vars; //variables of nested PARALLEL FOR and REDUCE
+    std::vector<ArrayAccess> arrays;
+
+    bool uses(const std::string &var) const;
+
+    void visit(Bin_OP *ast);
+    void visit(Un_OP *ast);
+    void visit(Var *ast);
+    void visit(Array *ast);
+    void visit(GoTo *ast);
+    void visit(Label *ast);
+    void visit(Num *ast);
+    void visit(BlockCode *ast);
+    void visit(IfElse *ast);
+    void visit(While *ast);
+    void visit(VarAssign *ast);
+    void visit(ArrAssign *ast);
+    void visit(VarDecl *ast);
+    void visit(ArrDecl *ast);
+    void visit(Print *ast);
+    void visit(ReadArr *ast);
+    void visit(ReadVar *ast);
+    void visit(ArrReduce *ast);
+    void visit(ArrDot *ast);
+    void visit(ArrFill *ast);
+    void visit(ArrCopy *ast);
+    void visit(ArrSort *ast);
+    void visit(ArrSearch *ast);
+    void visit(ArrFile *ast);
+    void visit(ForEach *ast);
+    void visit(ParallelFor *ast);
+    void visit(Reduce *ast);
+    void visit(AtomicOp *ast);
+    void visit(Spawn *ast);
+    void visit(Join *ast);
+    void visit(Yield *ast);
+    void visit(ChanDecl *ast);
+    void visit(Send *ast);
+    void visit(Recv *ast);
+    void visit(NO_OP *ast);
+
+private:
+    bool writing = false; //set while the target of an ArrAssign or ATOMIC is visited
+    const AtomicOp *atomic = nullptr;
+};
+
+//how a qualifying loop is run
+struct ParallelLoop
+{
+    std::string var; //the induction variable
+    AST_Node *bound;
+    bool inclusive; //i <= bound instead of i < bound
+
+    BlockCode *body;
+    AST_Node *step; //the closing i = i + 1, the workers leave it out
+
+    //assigned first thing in every iteration, the last iteration's value is written back
+    std::vector<std::string> private_vars;
+    //used only inside a nested block or never assigned, the loop runs sequentially when they exist outside it
+    std::vector<std::string> local_vars;
+    //arrays declared in the body, they are shadowed by arrays of the same name outside the loop
+    std::vector<std::string> local_arrays;
+    //arrays declared outside the body that it writes, the loop runs sequentially when one of them is SPARSE
+    std::vector<std::string> written_arrays;
+    std::unordered_set<std::string> declared_vars;
+};
+
+typedef std::unordered_map<const While *, ParallelLoop> ParallelLoops;
+
+struct LoopReport
+{
+    int line;
+    bool parallel;
+    std::string reason;
+};
+
+class LoopAnalyzer : public Visitor
+{
+public:
+    ParallelLoops loops;
+    std::vector<LoopReport> report; //one entry per WHILE, in source order
+
+    void write_report(std::ostream &out) const;
+
+    void visit(Bin_OP *ast);
+    void visit(Un_OP *ast);
+    void visit(Var *ast);
+    void visit(Array *ast);
+    void visit(GoTo *ast);
+    void visit(Label *ast);
+    void visit(Num *ast);
+    void visit(BlockCode *ast);
+    void visit(IfElse *ast);
+    void visit(While *ast);
+    void visit(VarAssign *ast);
+    void visit(ArrAssign *ast);
+    void visit(VarDecl *ast);
+    void visit(ArrDecl *ast);
+    void visit(Print *ast);
+    void visit(ReadArr *ast);
+    void visit(ReadVar *ast);
+    void visit(ArrReduce *ast);
+    void visit(ArrDot *ast);
+    void visit(ArrFill *ast);
+    void visit(ArrCopy *ast);
+    void visit(ArrSort *ast);
+    void visit(ArrSearch *ast);
+    void visit(ArrFile *ast);
+    void visit(ForEach *ast);
+    void visit(ParallelFor *ast);
+    void visit(Reduce *ast);
+    void visit(AtomicOp *ast);
+    void visit(Spawn *ast);
+    void visit(Join *ast);
+    void visit(Yield *ast);
+    void visit(ChanDecl *ast);
+    void visit(Send *ast);
+    void visit(Recv *ast);
+    void visit(NO_OP *ast);
+
+private:
+    //fills plan and returns an empty string when the loop qualifies, otherwise why it does not
+    std::string analyze(While *ast, ParallelLoop &plan);
+
+    static bool is_var(AST_Node *node, const std::string &name);
+    //matches i, i + c, c + i and i - c for a literal c
+    static bool induction_offset(AST_Node *node, const std::string &var, long long &offset);
+    //true when every pass through statements[from..] assigns var before reading it;
+    //nested is set when that happens only inside a nested block
+    static bool assigned_first(const std::vector<AST_Node *> &statements, std::size_t from, std::size_t end,
+                               const std::string &var, bool &nested);
+};
+
+#include "loop_analysis.inl"
+
+#endif
\ No newline at end of file
@@ -0,0 +1,579 @@
+#ifndef LOOP_ANALYSIS_SOURCE
+#define LOOP_ANALYSIS_SOURCE
+
+//LOOP SCANNER
+
+inline bool LoopScanner::uses(const std::string &var) const
+{
+    return reads.count(var) || writes.count(var);
+}
+
+inline void LoopScanner::visit(Bin_OP *ast)
+{
+    ast->left->accept(*this);
+    ast->right->accept(*this);
+}
+
+inline void LoopScanner::visit(Un_OP *ast)
+{
+    ast->expr->accept(*this);
+}
+
+inline void LoopScanner::visit(Var *ast)
+{
+    reads.insert(ast->token.text_data);
+}
+
+inline void LoopScanner::visit(Array *ast)
+{
+    arrays.push_back(ArrayAccess{ast->token.text_data, &ast->indices, writing, atomic});
+    writing = false;
+    atomic = nullptr;
+
+    for (int i = 0; i < ast->indices.size(); ++i)
+        ast->indices[i]->accept(*this);
+}
+
+inline void LoopScanner::visit(GoTo *ast)
+{
+    if (forbidden.empty())
+        forbidden = "GOTO";
+}
+
+inline void LoopScanner::visit(Label *ast)
+{
+    if (forbidden.empty())
+        forbidden = "LABEL";
+}
+
+inline void LoopScanner::visit(Num *ast){};
+
+inline void LoopScanner::visit(BlockCode *ast)
+{
+    for (int i = 0; i < ast->statements.size(); ++i)
+        ast->statements[i]->accept(*this);
+}
+
+inline void LoopScanner::visit(IfElse *ast)
+{
+    ast->expr->accept(*this);
+    ast->bCode1->accept(*this);
+    ast->bCode2->accept(*this);
+}
+
+inline void LoopScanner::visit(While *ast)
+{
+    ast->expr->accept(*this);
+    ast->bCode->accept(*this);
+}
+
+inline void LoopScanner::visit(VarAssign *ast)
+{
+    writes.insert(static_cast<Var *>(ast->var)->token.text_data);
+    ast->expr->accept(*this);
+}
+
+inline void LoopScanner::visit(ArrAssign *ast)
+{
+    writing = true;
+    ast->arr->accept(*this);
+    ast->expr->accept(*this);
+}
+
+inline void LoopScanner::visit(VarDecl *ast)
+{
+    declared_vars.insert(static_cast<Var *>(ast->var)->token.text_data);
+}
+
+inline void LoopScanner::visit(ArrDecl *ast)
+{
+    Array *arr = static_cast<Array *>(ast->arr);
+    declared_arrays.insert(arr->token.text_data);
+
+    for (int i = 0; i < arr->indices.size(); ++i)
+        arr->indices[i]->accept(*this);
+}
+
+inline void LoopScanner::visit(Print *ast)
+{
+    if (forbidden.empty())
+        forbidden = "PRINT";
+}
+
+inline void LoopScanner::visit(ReadArr *ast)
+{
+    if (forbidden.empty())
+        forbidden = "READ";
+}
+
+inline void LoopScanner::visit(ReadVar *ast)
+{
+    if (forbidden.empty())
+        forbidden = "READ";
+}
+
+inline void LoopScanner::visit(ArrReduce *ast)
+{
+    arrays.push_back(ArrayAccess{ast->arr.text_data, nullptr, false, nullptr});
+    ast->count->accept(*this);
+}
+
+inline void LoopScanner::visit(ArrDot *ast)
+{
+    arrays.push_back(ArrayAccess{ast->left.text_data, nullptr, false, nullptr});
+    arrays.push_back(ArrayAccess{ast->right.text_data, nullptr, false, nullptr});
+    ast->count->accept(*this);
+}
+
+inline void LoopScanner::visit(ArrFill *ast)
+{
+    arrays.push_back(ArrayAccess{ast->arr.text_data, nullptr, true, nullptr});
+    ast->expr->accept(*this);
+}
+
+inline void LoopScanner::visit(ArrCopy *ast)
+{
+    arrays.push_back(ArrayAccess{ast->from.text_data, nullptr, false, nullptr});
+    arrays.push_back(ArrayAccess{ast->to.text_data, nullptr, true, nullptr});
+}
+
+inline void LoopScanner::visit(ArrSort *ast)
+{
+    arrays.push_back(ArrayAccess{ast->arr.text_data, nullptr, true, nullptr});
+    ast->count->accept(*this);
+}
+
+//file I/O keeps the loop sequential like READ and PRINT do
+inline void LoopScanner::visit(ArrFile *ast)
+{
+    if (ast->count)
+        ast->count->accept(*this);
+    if (forbidden.empty())
+        forbidden = ast->op.t == Token::LOAD ? "LOAD" : "STORE";
+}
+
+//the whole array is read before the body runs, key and val are declared for the body like a loop variable
+inline void LoopScanner::visit(ForEach *ast)
+{
+    arrays.push_back(ArrayAccess{ast->arr.text_data, nullptr, false, nullptr});
+    loop_vars.insert(ast->key.text_data);
+    loop_vars.insert(ast->val.text_data);
+    ast->bCode->accept(*this);
+}
+
+inline void LoopScanner::visit(ArrSearch *ast)
+{
+    arrays.push_back(ArrayAccess{ast->arr.text_data, nullptr, false, nullptr});
+    ast->count->accept(*this);
+    ast->key->accept(*this);
+}
+
+inline void LoopScanner::visit(ParallelFor *ast)
+{
+    loop_vars.insert(ast->var.text_data);
+    ast->from->accept(*this);
+    ast->to->accept(*this);
+    ast->bCode->accept(*this);
+}
+
+//the target is read as well, its old value is folded into the result
+inline void LoopScanner::visit(Reduce *ast)
+{
+    loop_vars.insert(ast->var.text_data);
+    reads.insert(ast->target.text_data);
+    writes.insert(ast->target.text_data);
+    ast->expr->accept(*this);
+    ast->from->accept(*this);
+    ast->to->accept(*this);
+}
+
+inline void LoopScanner::visit(AtomicOp *ast)
+{
+    writing = true;
+    atomic = ast;
+    ast->arr->accept(*this);
+    ast->expr->accept(*this);
+
+    if (ast->op.t == Token::CAS)
+    {
+        ast->desired->accept(*this);
+        writes.insert(ast->result.text_data);
+    }
+}
+
+inline void LoopScanner::visit(Spawn *ast)
+{
+    if (ast->expr)
+        ast->expr->accept(*this);
+    if (forbidden.empty())
+        forbidden = "SPAWN";
+}
+
+inline void LoopScanner::visit(Join *ast)
+{
+    if (forbidden.empty())
+        forbidden = "JOIN";
+}
+
+inline void LoopScanner::visit(Yield *ast)
+{
+    if (forbidden.empty())
+        forbidden = "YIELD";
+}
+
+inline void LoopScanner::visit(ChanDecl *ast)
+{
+    if (forbidden.empty())
+        forbidden = "CHAN";
+}
+
+inline void LoopScanner::visit(Send *ast)
+{
+    if (forbidden.empty())
+        forbidden = "SEND";
+}
+
+inline void LoopScanner::visit(Recv *ast)
+{
+    if (forbidden.empty())
+        forbidden = "RECV";
+}
+
+inline void LoopScanner::visit(NO_OP *ast){};
+
+//LOOP ANALYZER
+
+inline void LoopAnalyzer::write_report(std::ostream &out) const
+{
+    for (int i = 0; i < report.size(); ++i)
+    {
+        out << "line " << report[i].line << ": ";
+        if (report[i].parallel)
+            out << "parallelized " << report[i].reason << "\n";
+        else
+            out << "not parallelized, " << report[i].reason << "\n";
+    }
+}
+
+inline void LoopAnalyzer::visit(Bin_OP *ast){};
+inline void LoopAnalyzer::visit(Un_OP *ast){};
+inline void LoopAnalyzer::visit(Var *ast){};
+inline void LoopAnalyzer::visit(Array *ast){};
+inline void LoopAnalyzer::visit(GoTo *ast){};
+inline void LoopAnalyzer::visit(Label *ast){};
+inline void LoopAnalyzer::visit(Num *ast){};
+
+inline void LoopAnalyzer::visit(BlockCode *ast)
+{
+    for (int i = 0; i < ast->statements.size(); ++i)
+        ast->statements[i]->accept(*this);
+}
+
+inline void LoopAnalyzer::visit(IfElse *ast)
+{
+    ast->bCode1->accept(*this);
+    ast->bCode2->accept(*this);
+}
+
+//a loop inside a parallelized loop already runs on a worker, so only loops of rejected ones are analyzed further
+inline void LoopAnalyzer::visit(While *ast)
+{
+    ParallelLoop plan;
+    std::string reason = analyze(ast, plan);
+
+    if (reason.empty())
+    {
+        reason = "over " + plan.var;
+        for (int i = 0; i < plan.private_vars.size(); ++i)
+            reason += (i == 0 ? ", private " : " ") + plan.private_vars[i];
+        for (int i = 0; i < plan.local_vars.size(); ++i)
+            reason += (i == 0 ? ", local " : " ") + plan.local_vars[i];
+
+        loops[ast] = plan;
+        report.push_back(LoopReport{ast->line, true, reason});
+        return;
+    }
+
+    report.push_back(LoopReport{ast->line, false, reason});
+    ast->bCode->accept(*this);
+}
+
+inline void LoopAnalyzer::visit(VarAssign *ast){};
+inline void LoopAnalyzer::visit(ArrAssign *ast){};
+inline void LoopAnalyzer::visit(VarDecl *ast){};
+inline void LoopAnalyzer::visit(ArrDecl *ast){};
+inline void LoopAnalyzer::visit(Print *ast){};
+inline void LoopAnalyzer::visit(ReadArr *ast){};
+inline void LoopAnalyzer::visit(ReadVar *ast){};
+inline void LoopAnalyzer::visit(ArrReduce *ast){};
+inline void LoopAnalyzer::visit(ArrDot *ast){};
+inline void LoopAnalyzer::visit(ArrFill *ast){};
+inline void LoopAnalyzer::visit(ArrCopy *ast){};
+inline void LoopAnalyzer::visit(ArrSort *ast){};
+inline void LoopAnalyzer::visit(ArrSearch *ast){};
+inline void LoopAnalyzer::visit(ArrFile *ast){};
+
+inline void LoopAnalyzer::visit(ForEach *ast)
+{
+    ast->bCode->accept(*this);
+}
+
+//loops inside PARALLEL FOR bodies run on its workers and are left alone
+inline void LoopAnalyzer::visit(ParallelFor *ast){};
+inline void LoopAnalyzer::visit(Reduce *ast){};
+inline void LoopAnalyzer::visit(AtomicOp *ast){};
+inline void LoopAnalyzer::visit(Spawn *ast){};
+inline void LoopAnalyzer::visit(Join *ast){};
+inline void LoopAnalyzer::visit(Yield *ast){};
+inline void LoopAnalyzer::visit(ChanDecl *ast){};
+inline void LoopAnalyzer::visit(Send *ast){};
+inline void LoopAnalyzer::visit(Recv *ast){};
+inline void LoopAnalyzer::visit(NO_OP *ast){};
+
+inline bool LoopAnalyzer::is_var(AST_Node *node, const std::string &name)
+{
+    Var *var = dynamic_cast<Var *>(node);
+    return var && var->token.text_data == name;
+}
+
+inline bool LoopAnalyzer::induction_offset(AST_Node *node, const std::string &var, long long &offset)
+{
+    if (is_var(node, var))
+    {
+        offset = 0;
+        return true;
+    }
+
+    Bin_OP *op = dynamic_cast<Bin_OP *>(node);
+    if (!op || (op->op.t != Token::PLUS && op->op.t != Token::MINUS))
+        return false;
+
+    Num *constant = dynamic_cast<Num *>(is_var(op->left, var) ? op->right : op->left);
+    if (!constant || !value_fits_long(constant->token.value, offset))
+        return false;
+
+    if (is_var(op->left, var))
+    {
+        //i - c, offsets this large never fit an index anyway
+        if (op->op.t == Token::MINUS)
+            offset = offset == LLONG_MIN ? LLONG_MAX : -offset;
+        return true;
+    }
+
+    //c + i, c - i runs backwards
+    return op->op.t == Token::PLUS && is_var(op->right, var);
+}
+
+inline bool LoopAnalyzer::assigned_first(const std::vector<AST_Node *> &statements, std::size_t from, std::size_t end,
+                                         const std::string &var, bool &nested)
+{
+    for (std::size_t k = from; k < end; ++k)
+    {
+        LoopScanner scanner;
+        statements[k]->accept(scanner);
+        if (!scanner.uses(var))
+            continue;
+
+        VarAssign *assign = dynamic_cast<VarAssign *>(statements[k]);
+        if (assign && is_var(assign->var, var))
+        {
+            LoopScanner expr;
+            assign->expr->accept(expr);
+            return !expr.uses(var);
+        }
+
+        //CAS only writes its result
+        AtomicOp *cas = dynamic_cast<AtomicOp *>(statements[k]);
+        if (cas && cas->op.t == Token::CAS && cas->result.text_data == var)
+            return !scanner.reads.count(var);
+
+        //otherwise var must live entirely inside this statement's blocks
+        for (std::size_t j = k + 1; j < end; ++j)
+        {
+            LoopScanner later;
+            statements[j]->accept(later);
+            if (later.uses(var))
+                return false;
+        }
+
+        LoopScanner condition;
+        std::vector<BlockCode *> blocks;
+        if (IfElse *branch = dynamic_cast<IfElse *>(statements[k]))
+        {
+            branch->expr->accept(condition);
+            blocks.push_back(static_cast<BlockCode *>(branch->bCode1));
+            blocks.push_back(static_cast<BlockCode *>(branch->bCode2));
+        }
+        else if (While *loop = dynamic_cast<While *>(statements[k]))
+        {
+            loop->expr->accept(condition);
+            blocks.push_back(static_cast<BlockCode *>(loop->bCode));
+        }
+        else
+            return false;
+
+        if (condition.uses(var))
+            return false;
+
+        for (int b = 0; b < blocks.size(); ++b)
+        {
+            LoopScanner block;
+            blocks[b]->accept(block);
+            if (block.uses(var) && !assigned_first(blocks[b]->statements, 0, blocks[b]->statements.size(), var, nested))
+                return false;
+        }
+
+        nested = true;
+        return true;
+    }
+
+    return true;
+}
+
+inline std::string LoopAnalyzer::analyze(While *ast, ParallelLoop &plan)
+{
+    //WHILE i < bound, WHILE i <= bound, or the same written as bound > i and bound >= i
+    Bin_OP *condition = dynamic_cast<Bin_OP *>(ast->expr);
+    if (condition && (condition->op.t == Token::LESS || condition->op.t == Token::LESSEQ) && dynamic_cast<Var *>(condition->left))
+    {
+        plan.var = static_cast<Var *>(condition->left)->token.text_data;
+        plan.bound = condition->right;
+        plan.inclusive = condition->op.t == Token::LESSEQ;
+    }
+    else if (condition && (condition->op.t == Token::MORE || condition->op.t == Token::MOREEQ) && dynamic_cast<Var *>(condition->right))
+    {
+        plan.var = static_cast<Var *>(condition->right)->token.text_data;
+        plan.bound = condition->left;
+        plan.inclusive = condition->op.t == Token::MOREEQ;
+    }
+    else
+        return "the condition is not i < bound or i <= bound";
+
+    //the body has to end with i = i + 1, the NO_OPs of empty lines don't count
+    plan.body = static_cast<BlockCode *>(ast->bCode);
+    std::vector<AST_Node *> &statements = plan.body->statements;
+
+    std::size_t end = statements.size();
+    while (end > 0 && dynamic_cast<NO_OP *>(statements[end - 1]))
+        --end;
+    if (end == 0)
+        return "the body does not end with " + plan.var + " = " + plan.var + " + 1";
+
+    VarAssign *step = dynamic_cast<VarAssign *>(statements[end - 1]);
+    Bin_OP *next = step ? dynamic_cast<Bin_OP *>(step->expr) : nullptr;
+    long long one;
+    if (!step || !is_var(step->var, plan.var) || !next || next->op.t != Token::PLUS ||
+        !induction_offset(next, plan.var, one) || one != 1)
+        return "the body does not end with " + plan.var + " = " + plan.var + " + 1";
+
+    plan.step = step;
+    --end;
+
+    LoopScanner body;
+    for (std::size_t k = 0; k < end; ++k)
+        statements[k]->accept(body);
+
+    if (!body.forbidden.empty())
+        return "the body uses " + body.forbidden;
+
+    if (body.writes.count(plan.var) || body.declared_vars.count(plan.var) || body.loop_vars.count(plan.var))
+        return plan.var + " changes inside the body";
+
+    for (std::unordered_set<std::string>::const_iterator it = body.loop_vars.begin(); it != body.loop_vars.end(); ++it)
+        if (body.writes.count(*it))
+            return *it + " is both assigned and used as a loop variable";
+
+    //arrays declared in the body belong to one iteration
+    for (std::unordered_set<std::string>::const_iterator it = body.declared_arrays.begin(); it != body.declared_arrays.end(); ++it)
+        plan.local_arrays.push_back(*it);
+
+    //every written array is touched only at the element the iteration owns
+    std::unordered_set<std::string> written;
+    for (int k = 0; k < body.arrays.size(); ++k)
+        if (body.arrays[k].write && !body.declared_arrays.count(body.arrays[k].name))
+            written.insert(body.arrays[k].name);
+    plan.written_arrays.assign(written.begin(), written.end());
+
+    std::unordered_map<std::string, long long> offsets;
+    for (std::unordered_set<std::string>::const_iterator it = written.begin(); it != written.end(); ++it)
+        offsets[*it] = LLONG_MIN;
+
+    //arrays only updated by one kind of commutative ATOMIC can take any index
+    for (std::unordered_map<std::string, long long>::iterator it = offsets.begin(); it != offsets.end();)
+    {
+        Token::type kind = Token::END;
+        for (int k = 0; k < body.arrays.size() && kind != Token::CAS; ++k)
+        {
+            const ArrayAccess &access = body.arrays[k];
+            if (access.name != it->first)
+                continue;
+
+            if (!access.atomic || (kind != Token::END && kind != access.atomic->op.t))
+                kind = Token::CAS;
+            else
+                kind = access.atomic->op.t;
+        }
+
+        if (kind != Token::CAS)
+            it = offsets.erase(it);
+        else
+            ++it;
+    }
+
+    for (int k = 0; k < body.arrays.size(); ++k)
+    {
+        const ArrayAccess &access = body.arrays[k];
+        std::unordered_map<std::string, long long>::iterator got = offsets.find(access.name);
+        if (got == offsets.end())
+            continue;
+
+        if (!access.indices)
+            return access.name + " is written and used as a whole in the body";
+
+        long long offset;
+        if (!induction_offset((*access.indices)[0], plan.var, offset))
+            return access.name + " is written, but not every access indexes it by " + plan.var + " plus a constant";
+
+        if (got->second != LLONG_MIN && got->second != offset)
+            return access.name + " is accessed at different offsets from " + plan.var;
+        got->second = offset;
+    }
+
+    //the bound is evaluated once
+    LoopScanner bound;
+    plan.bound->accept(bound);
+    for (std::unordered_set<std::string>::const_iterator it = bound.reads.begin(); it != bound.reads.end(); ++it)
+        if (*it == plan.var || body.writes.count(*it))
+            return "the bound changes inside the loop";
+    for (int k = 0; k < bound.arrays.size(); ++k)
+        if (written.count(bound.arrays[k].name))
+            return "the bound changes inside the loop";
+
+    //the other assigned variables get a copy per worker, so no iteration may see the value of an earlier one
+    for (std::unordered_set<std::string>::const_iterator it = body.writes.begin(); it != body.writes.end(); ++it)
+    {
+        bool nested = false;
+        if (!assigned_first(statements, 0, end, *it, nested))
+            return *it + " is assigned in the body and may be read before it is assigned";
+
+        //the workers could never assign it, so the loop would always run sequentially
+        if (nested && !body.declared_vars.count(*it))
+            return *it + " is declared outside the loop and only assigned inside a nested block";
+
+        if (nested)
+            plan.local_vars.push_back(*it);
+        else
+            plan.private_vars.push_back(*it);
+    }
+
+    //declared but never assigned, they only ever hold their initial value
+    for (std::unordered_set<std::string>::const_iterator it = body.declared_vars.begin(); it != body.declared_vars.end(); ++it)
+        if (!body.writes.count(*it))
+            plan.local_vars.push_back(*it);
+
+    plan.declared_vars = body.declared_vars;
+
+    return "";
+}
+
+#endif
\ No newline at end of file
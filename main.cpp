@@ -1,7 +1,14 @@
 #include <iostream>
 #include <string>
 #include <fstream>
-#include "interpreter.h"
+#include "batch_interpreter.h"
+#include "runner.h"
+#include "profiler.h"
+#include "sampler.h"
+#include "perf_counters.h"
+#include "tracer.h"
+#include "sessions.h"
+#include "daemon.h"
 
 int main()
 {
@@ -9,7 +16,7 @@ int main()
     //Lexer lexer("LET a \n a = 10 \n LET b \n LET c \n READ a \n READ b \n READ c \n PRINT a \n PRINT b \n PRINT c");
 
     int c;
-    std::cout << "0-import program from text file / 1-enter REPL MODE \n";
+    std::cout << "0-import program from text file / 1-enter REPL MODE / 2-run program over many input files / 3-run many programs in parallel / 4-profile program from text file / 5-sample program for a flame graph / 6-run program with hardware counters / 7-trace program execution / 8-run program and report which loops run in parallel / 9-serve program to many clients over TCP / 10-run as a daemon on a Unix socket \n";
     std::cin >> c;
 
     if (c == 0)
@@ -29,7 +36,303 @@ int main()
 
         std::cin.ignore();
         Interpreter interpreter(tree);
-        interpreter.interpret_fullprogram();
+        try
+        {
+            interpreter.interpret_fullprogram();
+        }
+        catch (const std::exception &e)
+        {
+            std::cout << "runtime error: " << e.what() << "\n";
+        }
+    }
+    else if (c == 2)
+    {
+        //every line of the list file names one input file, the lane's output goes next to it as <input>.out
+        std::string filename, listname, input, lane;
+        std::cout << "Enter full file name:";
+        std::cin >> filename;
+        std::cout << "Enter file with the list of input files:";
+        std::cin >> listname;
+
+        std::fstream file;
+        file.open(filename, std::fstream::in);
+        std::getline(file, input, '\0');
+        file.close();
+
+        std::vector<std::istream *> inputs;
+        std::vector<std::ostream *> outputs;
+
+        std::fstream list;
+        list.open(listname, std::fstream::in);
+        while (std::getline(list, lane))
+        {
+            if (lane.empty())
+                continue;
+
+            inputs.push_back(new std::ifstream(lane));
+            outputs.push_back(new std::ofstream(lane + ".out"));
+        }
+        list.close();
+
+        Lexer lexer(input);
+        Parser parser(lexer);
+        AST_Node *tree = parser.parse();
+
+        BatchInterpreter interpreter(tree, inputs, outputs);
+        try
+        {
+            interpreter.interpret_fullprogram();
+        }
+        catch (const std::exception &e)
+        {
+            std::cout << "runtime error: " << e.what() << "\n";
+        }
+
+        for (int i = 0; i < inputs.size(); ++i)
+        {
+            delete inputs[i];
+            delete outputs[i];
+        }
+    }
+    else if (c == 3)
+    {
+        //every line of the list file holds a program file and the input file for that run
+        std::string listname, program, inputname, contents;
+        std::cout << "Enter file with the list of programs and inputs:";
+        std::cin >> listname;
+
+        std::vector<std::string> names;
+        std::vector<RunJob> jobs;
+
+        std::fstream list;
+        list.open(listname, std::fstream::in);
+        while (list >> program >> inputname)
+        {
+            RunJob job;
+
+            std::fstream file;
+            file.open(program, std::fstream::in);
+            std::getline(file, job.program, '\0');
+            file.close();
+
+            file.open(inputname, std::fstream::in);
+            std::getline(file, job.input, '\0');
+            file.close();
+
+            names.push_back(program + " " + inputname);
+            jobs.push_back(job);
+        }
+        list.close();
+
+        ThreadPool pool;
+        ProgramRunner runner(pool);
+        std::vector<RunResult> results = runner.run_all(jobs);
+
+        for (int i = 0; i < results.size(); ++i)
+        {
+            std::cout << "== " << names[i] << " ==\n";
+            std::cout << results[i].output;
+            if (!results[i].ok)
+                std::cout << "error: " << results[i].error << "\n";
+        }
+    }
+    else if (c == 4)
+    {
+        std::string filename, input;
+        std::cout << "Enter full file name:";
+        std::cin >> filename;
+
+        std::fstream file;
+        file.open(filename, std::fstream::in);
+        std::getline(file, input, '\0');
+        file.close();
+
+        CompiledProgram program = compile(input);
+
+        std::cin.ignore();
+        ProfilingInterpreter profiler;
+        profiler.execute(program.root(), program.labels(), console_input(), console_output());
+
+        std::ofstream report(filename + ".prof");
+        profiler.write_report(report, input);
+        std::cout << "profile written to " << filename << ".prof\n";
+    }
+    else if (c == 5)
+    {
+        std::string filename, input;
+        long period;
+        std::cout << "Enter full file name:";
+        std::cin >> filename;
+        std::cout << "Enter sampling period in microseconds (0 to sample every 1000 statements):";
+        std::cin >> period;
+
+        std::fstream file;
+        file.open(filename, std::fstream::in);
+        std::getline(file, input, '\0');
+        file.close();
+
+        CompiledProgram program = compile(input);
+
+        std::cin.ignore();
+        SamplingInterpreter sampler(period > 0 ? SamplingInterpreter::TIMER : SamplingInterpreter::STATEMENTS,
+                                    period > 0 ? period : 1000);
+        sampler.start();
+        sampler.execute(program.root(), program.labels(), console_input(), console_output());
+        sampler.stop();
+
+        std::ofstream folded(filename + ".folded");
+        sampler.write_collapsed(folded, input);
+        std::cout << sampler.samples_taken() << " samples written to " << filename << ".folded\n";
+    }
+    else if (c == 6)
+    {
+        std::string filename, input;
+        std::cout << "Enter full file name:";
+        std::cin >> filename;
+
+        std::fstream file;
+        file.open(filename, std::fstream::in);
+        std::getline(file, input, '\0');
+        file.close();
+
+        PerfCounters counters;
+        std::vector<PhaseCounters> phases;
+
+        //the parser pulls its tokens from the lexer, so lexing is also measured on its own
+        counters.start();
+        Lexer tokens(input);
+        while (tokens.get_next_token().t != Token::END)
+            ;
+        phases.push_back(counters.stop("lex"));
+
+        counters.start();
+        Lexer lexer(input);
+        Parser parser(lexer);
+        AST_Node *tree = parser.parse();
+        phases.push_back(counters.stop("parse"));
+
+        counters.start();
+        BeforeInterpret labels;
+        tree->accept(labels);
+        phases.push_back(counters.stop("labels"));
+
+        std::cin.ignore();
+        Interpreter interpreter;
+        counters.start();
+        interpreter.execute(tree, labels.labels, console_input(), console_output());
+        phases.push_back(counters.stop("execute"));
+
+        Deleter deleter;
+        tree->accept(deleter);
+
+        if (!counters.available())
+            std::cout << "hardware counters are not available, showing wall-clock time only\n";
+        PerfCounters::write_report(std::cout, phases);
+    }
+    else if (c == 7)
+    {
+        std::string filename, input;
+        std::cout << "Enter full file name:";
+        std::cin >> filename;
+
+        std::fstream file;
+        file.open(filename, std::fstream::in);
+        std::getline(file, input, '\0');
+        file.close();
+
+        Tracer tracer(filename + ".trace.json");
+
+        tracer.phase_begin("compile");
+        CompiledProgram program = compile(input);
+        tracer.phase_end("compile");
+
+        std::cin.ignore();
+        TracingInterpreter interpreter(tracer);
+        tracer.phase_begin("execute");
+        interpreter.execute(program.root(), program.labels(), console_input(), console_output());
+        tracer.phase_end("execute");
+
+        tracer.close();
+        std::cout << "trace written to " << filename << ".trace.json\n";
+    }
+    else if (c == 8)
+    {
+        std::string filename, input;
+        std::cout << "Enter full file name:";
+        std::cin >> filename;
+
+        std::fstream file;
+        file.open(filename, std::fstream::in);
+        std::getline(file, input, '\0');
+        file.close();
+
+        CompiledProgram program = compile(input);
+        program.loops().write_report(std::cout);
+
+        //the analysis is static, some parallelized loops still run sequentially because of the values they meet
+        std::map<int, std::string> fallbacks;
+        Interpreter interpreter;
+        interpreter.log_loop_fallbacks(&fallbacks);
+
+        std::cin.ignore();
+        try
+        {
+            interpreter.execute(program.root(), program.labels(), console_input(), console_output(), &program.loops().loops);
+        }
+        catch (const std::exception &e)
+        {
+            std::cout << "runtime error: " << e.what() << "\n";
+        }
+
+        for (std::map<int, std::string>::const_iterator it = fallbacks.begin(); it != fallbacks.end(); ++it)
+            std::cout << "line " << it->first << ": ran sequentially, " << it->second << "\n";
+    }
+    else if (c == 9)
+    {
+        std::string filename, input;
+        int port;
+        std::cout << "Enter full file name:";
+        std::cin >> filename;
+        std::cout << "Enter port (0 picks a free one):";
+        std::cin >> port;
+
+        std::fstream file;
+        file.open(filename, std::fstream::in);
+        std::getline(file, input, '\0');
+        file.close();
+
+        CompiledProgram program = compile(input);
+
+        try
+        {
+            SessionServer server(program, port);
+            std::cout << "serving on 127.0.0.1:" << server.port() << std::endl;
+            server.run();
+        }
+        catch (const std::exception &e)
+        {
+            std::cout << "server error: " << e.what() << "\n";
+        }
+    }
+    else if (c == 10)
+    {
+        std::string path;
+        std::size_t workers;
+        std::cout << "Enter socket path:";
+        std::cin >> path;
+        std::cout << "Enter number of workers (0 for one per core):";
+        std::cin >> workers;
+
+        try
+        {
+            Daemon daemon(path, workers);
+            std::cout << "listening on " << path << std::endl;
+            daemon.run();
+        }
+        catch (const std::exception &e)
+        {
+            std::cout << "daemon error: " << e.what() << "\n";
+        }
     }
     else
     {
@@ -0,0 +1,30 @@
+#pragma once
+
+#ifndef PARALLEL_SORT_HEADER
+#define PARALLEL_SORT_HEADER
+
+#include <algorithm>
+#include <future>
+#include <iterator>
+#include <vector>
+
+#include "thread_pool.h"
+
+////PARALLEL SORT////
+//the built-ins behind SORT a, n and BSEARCH(a, n, key)
+
+//below this many elements starting threads costs more than it saves
+static const long long PARALLEL_SORT_THRESHOLD = 1 << 16;
+
+//sorts the first n elements ascending: one run per pool worker is sorted at the same time,
+//then neighbouring runs are merged pairwise, every round's merges running in parallel too
+template <class T>
+void parallel_sort(T *data, long long n, ThreadPool &pool);
+
+//position of the first element equal to key in n sorted elements, -1 when there is none
+template <class T>
+long long sorted_search(const T *data, long long n, const T &key);
+
+#include "parallel_sort.inl"
+
+#endif
\ No newline at end of file
@@ -0,0 +1,71 @@
+#ifndef PARALLEL_SORT_SOURCE
+#define PARALLEL_SORT_SOURCE
+
+template <class T>
+inline void parallel_sort(T *data, long long n, ThreadPool &pool)
+{
+    std::size_t workers = pool.size();
+    if (n < PARALLEL_SORT_THRESHOLD || workers < 2)
+    {
+        std::sort(data, data + n);
+        return;
+    }
+
+    std::vector<long long> bounds(workers + 1);
+    for (std::size_t i = 0; i <= workers; ++i)
+        bounds[i] = n * i / workers;
+
+    std::vector<std::future<void>> tasks;
+    for (std::size_t i = 0; i < workers; ++i)
+    {
+        long long lo = bounds[i], hi = bounds[i + 1];
+        tasks.push_back(pool.submit([data, lo, hi]() { std::sort(data + lo, data + hi); }));
+    }
+    for (std::size_t i = 0; i < tasks.size(); ++i)
+        pool.wait(tasks[i]);
+
+    //runs move between data and the buffer every round, an odd run out is just moved across
+    std::vector<T> buffer(n);
+    T *from = data;
+    T *to = buffer.data();
+
+    while (bounds.size() > 2)
+    {
+        std::vector<long long> merged;
+        tasks.clear();
+
+        for (std::size_t i = 0; i + 1 < bounds.size(); i += 2)
+        {
+            long long lo = bounds[i], mid = bounds[i + 1];
+            long long hi = i + 2 < bounds.size() ? bounds[i + 2] : mid;
+
+            merged.push_back(lo);
+            tasks.push_back(pool.submit([from, to, lo, mid, hi]() {
+                std::merge(std::make_move_iterator(from + lo), std::make_move_iterator(from + mid),
+                           std::make_move_iterator(from + mid), std::make_move_iterator(from + hi), to + lo);
+            }));
+        }
+        merged.push_back(n);
+
+        for (std::size_t i = 0; i < tasks.size(); ++i)
+            pool.wait(tasks[i]);
+
+        std::swap(from, to);
+        bounds = merged;
+    }
+
+    if (from != data)
+        std::move(from, from + n, data);
+}
+
+template <class T>
+inline long long sorted_search(const T *data, long long n, const T &key)
+{
+    const T *found = std::lower_bound(data, data + n, key);
+    if (found == data + n || key < *found)
+        return -1;
+
+    return found - data;
+}
+
+#endif
\ No newline at end of file
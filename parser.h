@@ -3,6 +3,11 @@
 #ifndef PARSER_HEADER
 #define PARSER_HEADER
 
+#include <algorithm>
+#include <initializer_list>
+#include <stdexcept>
+#include <vector>
+
 //DELETE TREE
 class Deleter : public Visitor
 {
@@ -23,17 +28,51 @@ class Deleter : public Visitor
     void visit(ArrAssign *ast);
     void visit(VarDecl *ast);
     void visit(ArrDecl *ast);
+    void visit(ArrReduce *ast);
+    void visit(ArrDot *ast);
+    void visit(ArrFill *ast);
+    void visit(ArrCopy *ast);
+    void visit(ArrSort *ast);
+    void visit(ArrSearch *ast);
+    void visit(ArrFile *ast);
+    void visit(ForEach *ast);
+    void visit(ParallelFor *ast);
+    void visit(Reduce *ast);
+    void visit(AtomicOp *ast);
+    void visit(Spawn *ast);
+    void visit(Join *ast);
+    void visit(Yield *ast);
+    void visit(ChanDecl *ast);
+    void visit(Send *ast);
+    void visit(Recv *ast);
     void visit(NO_OP *ast);
 };
 
 ////PARSER////
+//every parenthesis, index or argument and every statement inside a block is one level of nesting,
+//and the parser stops at MAX_NESTING of them. every later pass walks the tree recursively as well,
+//so this keeps a deeply nested program or READ input from running out of the 8 MB stack of a thread or a task.
+//operator chains are no nesting, 1 + 2 + ... can be as long as memory allows
+static const int MAX_NESTING = 2000;
+
 class Parser
 {
 private:
     Deleter deleter; //when error occurs we delete the ast with this
 
+    int nesting = 0;
+    //one level of depth for as long as the rule runs
+    struct Nested
+    {
+        int &depth;
+        explicit Nested(int &d);
+        ~Nested();
+    };
+
     Lexer lexer;
     Token current_token;
+    //statements that need the program's order (READ, PRINT, GOTO, LABEL) are refused inside PARALLEL FOR
+    int parallel_depth = 0;
     void error();
     void eat(Token::type input_type);
 
@@ -43,6 +82,8 @@ public:
     AST_Node *Program_Lines();
     AST_Node *Statement();
     AST_Node *Expression();
+    //operand (op operand)*, in a loop instead of one recursion per operator
+    AST_Node *chain(AST_Node *(Parser::*operand)(), std::initializer_list<Token::type> ops);
     AST_Node *AND_Exp();
     AST_Node *NOT_Exp();
     AST_Node *COMPARE_Exp();
@@ -50,6 +91,7 @@ public:
     AST_Node *MULT_Exp();
     AST_Node *NEGATE_Exp();
     AST_Node *Value();
+    std::vector<AST_Node *> Indices();
     AST_Node *parse();
 };
 
@@ -6,6 +6,18 @@ inline Parser::Parser(Lexer &_lexer) : lexer(_lexer)
     current_token = lexer.get_next_token();
 };
 
+inline Parser::Nested::Nested(int &d) : depth(d)
+{
+    if (depth >= MAX_NESTING)
+        throw std::invalid_argument("the program is nested too deeply");
+    ++depth;
+}
+
+inline Parser::Nested::~Nested()
+{
+    --depth;
+}
+
 inline void Parser::error()
 {
     //cout << "parser error";
@@ -24,7 +36,7 @@ inline void Parser::eat(Token::type input_type)
 
 inline AST_Node *Parser::Program_Lines()
 {
-    AST_Node *node;
+    AST_Node *node = nullptr;
 
     try
     {
@@ -43,7 +55,8 @@ inline AST_Node *Parser::Program_Lines()
     }
     catch (...)
     {
-        node->accept(deleter);
+        if (node)
+            node->accept(deleter);
         throw std::invalid_argument("something went wrong");
     }
 
@@ -52,14 +65,23 @@ inline AST_Node *Parser::Program_Lines()
 
 inline AST_Node *Parser::Statement()
 {
+    Nested level(nesting);
 
-    AST_Node *node;
+    AST_Node *node = nullptr;
+
+    Token start = current_token;
 
     try
     {
 
         Token token = current_token;
 
+        if (parallel_depth && (token.t == Token::READ || token.t == Token::PRINT || token.t == Token::GOTO || token.t == Token::LABEL ||
+                               token.t == Token::SPAWN || token.t == Token::JOIN || token.t == Token::YIELD ||
+                               token.t == Token::CHAN || token.t == Token::SEND || token.t == Token::RECV ||
+                               token.t == Token::LOAD || token.t == Token::STORE))
+            error();
+
         if (token.t == Token::LET)
         {
             eat(Token::LET);
@@ -74,12 +96,21 @@ inline AST_Node *Parser::Statement()
 
                 if (token.t == Token::SQ_LPAREN)
                 {
-
-                    eat(Token::SQ_LPAREN);
-
-                    node = new ArrDecl(new Array(id, Expression()));
-
-                    eat(Token::SQ_RPAREN);
+                    ArrDecl *decl = new ArrDecl(new Array(id, Indices()));
+                    node = decl;
+
+                    if (current_token.t == Token::MAP)
+                    {
+                        eat(Token::MAP);
+                        decl->storage = current_token;
+                        decl->storage.t = Token::MAP;
+                        eat(Token::STRING);
+                    }
+                    else if (current_token.t == Token::SPARSE)
+                    {
+                        decl->storage = current_token;
+                        eat(Token::SPARSE);
+                    }
                 }
                 else
                 {
@@ -102,13 +133,13 @@ inline AST_Node *Parser::Statement()
             }
             else if (token.t == Token::SQ_LPAREN)
             {
-                eat(Token::SQ_LPAREN);
-                AST_Node *_index = Expression();
-                eat(Token::SQ_RPAREN);
+                //the array is kept in node until the assignment owns it, so a parse error below deletes it
+                AST_Node *arr = new Array(id, Indices());
+                node = arr;
 
                 eat(Token::ASSIGN);
 
-                node = new ArrAssign(new Array(id, _index), Expression());
+                node = new ArrAssign(arr, Expression());
             }
         }
         else if (token.t == Token::PRINT)
@@ -128,12 +159,7 @@ inline AST_Node *Parser::Statement()
 
             if (token.t == Token::SQ_LPAREN)
             {
-
-                eat(Token::SQ_LPAREN);
-
-                node = new ReadArr(new Array(id, Expression()));
-
-                eat(Token::SQ_RPAREN);
+                node = new ReadArr(new Array(id, Indices()));
             }
             else
             {
@@ -200,6 +226,172 @@ inline AST_Node *Parser::Statement()
 
             node = new While(expr, new BlockCode(block_statements));
         }
+        else if (token.t == Token::PARALLEL)
+        {
+            eat(Token::PARALLEL);
+            eat(Token::FOR);
+
+            Token var = current_token;
+            eat(Token::ID);
+            eat(Token::ASSIGN);
+
+            //the parts are attached as soon as they are parsed, so an error deletes everything through node
+            ParallelFor *loop = new ParallelFor(var, nullptr, nullptr, nullptr);
+            node = loop;
+
+            loop->from = Expression();
+            eat(Token::TO);
+            loop->to = Expression();
+
+            BlockCode *body = new BlockCode(std::vector<AST_Node *>());
+            loop->bCode = body;
+
+            ++parallel_depth;
+            try
+            {
+                body->statements.push_back(Statement());
+                while (current_token.t != Token::DONE)
+                {
+                    eat(Token::NEWLINE);
+                    body->statements.push_back(Statement());
+                }
+            }
+            catch (...)
+            {
+                --parallel_depth;
+                throw;
+            }
+            --parallel_depth;
+
+            eat(Token::DONE);
+        }
+        else if (token.t == Token::REDUCE)
+        {
+            eat(Token::REDUCE);
+
+            Token op = current_token;
+            if (op.t != Token::SUM && op.t != Token::MIN && op.t != Token::MAX)
+                error();
+            eat(op.t);
+
+            Token target = current_token;
+            eat(Token::ID);
+            eat(Token::ASSIGN);
+
+            Reduce *reduce = new Reduce(op, target, nullptr, Token(), nullptr, nullptr);
+            node = reduce;
+
+            reduce->expr = Expression();
+            eat(Token::FOR);
+
+            reduce->var = current_token;
+            eat(Token::ID);
+            eat(Token::ASSIGN);
+
+            reduce->from = Expression();
+            eat(Token::TO);
+            reduce->to = Expression();
+        }
+        else if (token.t == Token::ATOMIC)
+        {
+            eat(Token::ATOMIC);
+
+            Token op = current_token;
+            if (op.t != Token::ADD && op.t != Token::MIN && op.t != Token::MAX && op.t != Token::CAS)
+                error();
+            eat(op.t);
+
+            Token id = current_token;
+            eat(Token::ID);
+
+            AtomicOp *atomic = new AtomicOp(op, nullptr, nullptr, nullptr, Token());
+            node = atomic;
+
+            atomic->arr = new Array(id, Indices());
+            eat(Token::COMMA);
+            atomic->expr = Expression();
+
+            if (op.t == Token::CAS)
+            {
+                eat(Token::COMMA);
+                atomic->desired = Expression();
+                eat(Token::TO);
+
+                atomic->result = current_token;
+                eat(Token::ID);
+            }
+        }
+        else if (token.t == Token::SPAWN)
+        {
+            eat(Token::SPAWN);
+
+            token = current_token;
+            eat(Token::ID);
+
+            Spawn *spawn = new Spawn(token, Token(), nullptr);
+            node = spawn;
+
+            if (current_token.t == Token::COMMA)
+            {
+                eat(Token::COMMA);
+
+                spawn->var = current_token;
+                eat(Token::ID);
+                eat(Token::ASSIGN);
+
+                spawn->expr = Expression();
+            }
+        }
+        else if (token.t == Token::JOIN)
+        {
+            eat(Token::JOIN);
+            node = new Join();
+        }
+        else if (token.t == Token::YIELD)
+        {
+            eat(Token::YIELD);
+            node = new Yield();
+        }
+        else if (token.t == Token::CHAN)
+        {
+            eat(Token::CHAN);
+
+            token = current_token;
+            eat(Token::ID);
+
+            ChanDecl *decl = new ChanDecl(token, nullptr);
+            node = decl;
+
+            eat(Token::SQ_LPAREN);
+            decl->capacity = Expression();
+            eat(Token::SQ_RPAREN);
+        }
+        else if (token.t == Token::SEND)
+        {
+            eat(Token::SEND);
+
+            token = current_token;
+            eat(Token::ID);
+            eat(Token::COMMA);
+
+            node = new Send(token, Expression());
+        }
+        else if (token.t == Token::RECV)
+        {
+            eat(Token::RECV);
+
+            Token chan = current_token;
+            eat(Token::ID);
+            eat(Token::COMMA);
+
+            Token id = current_token;
+            eat(Token::ID);
+
+            if (current_token.t == Token::SQ_LPAREN)
+                node = new Recv(chan, nullptr, new Array(id, Indices()));
+            else
+                node = new Recv(chan, new Var(id), nullptr);
+        }
         else if (token.t == Token::GOTO)
         {
             eat(Token::GOTO);
@@ -221,71 +413,159 @@ inline AST_Node *Parser::Statement()
 
             node = new Label(token);
         }
+        else if (token.t == Token::FILL)
+        {
+            eat(Token::FILL);
+
+            Token arr = current_token;
+            eat(Token::ID);
+            eat(Token::COMMA);
+
+            node = new ArrFill(arr, Expression());
+        }
+        else if (token.t == Token::COPY)
+        {
+            eat(Token::COPY);
+
+            Token from = current_token;
+            eat(Token::ID);
+            eat(Token::TO);
+
+            Token to = current_token;
+            eat(Token::ID);
+
+            node = new ArrCopy(from, to);
+        }
+        else if (token.t == Token::SORT)
+        {
+            eat(Token::SORT);
+
+            Token arr = current_token;
+            eat(Token::ID);
+            eat(Token::COMMA);
+
+            node = new ArrSort(arr, Expression());
+        }
+        else if (token.t == Token::LOAD || token.t == Token::STORE)
+        {
+            eat(token.t);
+
+            bool text = current_token.t == Token::TEXT;
+            if (text)
+                eat(Token::TEXT);
+
+            Token arr = current_token;
+            eat(Token::ID);
+            eat(token.t == Token::LOAD ? Token::FROM : Token::TO);
+
+            Token file = current_token;
+            eat(Token::STRING);
+
+            ArrFile *io = new ArrFile(token, arr, file, text, nullptr);
+            node = io;
+
+            if (current_token.t == Token::COMMA)
+            {
+                eat(Token::COMMA);
+                io->count = Expression();
+            }
+        }
+        else if (token.t == Token::FOR)
+        {
+            eat(Token::FOR);
+
+            Token key = current_token;
+            eat(Token::ID);
+            eat(Token::COMMA);
+            Token val = current_token;
+            eat(Token::ID);
+            if (key.text_data == val.text_data)
+                error();
+            eat(Token::IN);
+
+            Token arr = current_token;
+            eat(Token::ID);
+
+            BlockCode *body = new BlockCode(std::vector<AST_Node *>());
+            node = new ForEach(key, val, arr, body);
+
+            body->statements.push_back(Statement());
+            while (current_token.t != Token::DONE)
+            {
+                eat(Token::NEWLINE);
+                body->statements.push_back(Statement());
+            }
+
+            eat(Token::DONE);
+        }
         else
         {
+            //an empty line, it has no source position of its own
             node = new NO_OP();
+            return node;
         }
     }
     catch (...)
     {
-        node->accept(deleter);
+        if (node)
+            node->accept(deleter);
         throw std::invalid_argument("something went wrong");
     }
 
+    //LET or an identifier that is not followed by what the grammar expects
+    if (!node)
+        error();
+
+    node->line = start.line;
+    node->column = start.column;
+
     return node;
 }
 
-inline AST_Node *Parser::Expression()
+//the chains lean right like the recursive rules they replace built them: a - b - c is a - (b - c)
+inline AST_Node *Parser::chain(AST_Node *(Parser::*operand)(), std::initializer_list<Token::type> ops)
 {
-    AST_Node *node;
+    std::vector<AST_Node *> operands;
+    std::vector<Token> operators;
 
     try
     {
-        node = AND_Exp();
-        Token token = current_token;
-
-        if (token.t == Token::OR)
+        operands.push_back((this->*operand)());
+        while (std::find(ops.begin(), ops.end(), current_token.t) != ops.end())
         {
-            eat(Token::OR);
-            node = new Bin_OP(token, node, Expression());
+            operators.push_back(current_token);
+            eat(current_token.t);
+            operands.push_back((this->*operand)());
         }
     }
     catch (...)
     {
-        node->accept(deleter);
+        for (std::size_t i = 0; i < operands.size(); ++i)
+            operands[i]->accept(deleter);
         throw std::invalid_argument("something went wrong");
     }
 
+    AST_Node *node = operands.back();
+    for (std::size_t i = operators.size(); i-- > 0;)
+        node = new Bin_OP(operators[i], operands[i], node);
+
     return node;
+}
+
+inline AST_Node *Parser::Expression()
+{
+    Nested level(nesting);
+    return chain(&Parser::AND_Exp, {Token::OR});
 };
 
 inline AST_Node *Parser::AND_Exp()
 {
-    AST_Node *node;
-
-    try
-    {
-        node = NOT_Exp();
-        Token token = current_token;
-
-        if (token.t == Token::AND)
-        {
-            eat(Token::AND);
-            node = new Bin_OP(token, node, AND_Exp());
-        }
-    }
-    catch (...)
-    {
-        node->accept(deleter);
-        throw std::invalid_argument("something went wrong");
-    }
-
-    return node;
+    return chain(&Parser::NOT_Exp, {Token::AND});
 };
 
 inline AST_Node *Parser::NOT_Exp()
 {
-    AST_Node *node;
+    AST_Node *node = nullptr;
 
     try
     {
@@ -300,7 +580,8 @@ inline AST_Node *Parser::NOT_Exp()
     }
     catch (...)
     {
-        node->accept(deleter);
+        if (node)
+            node->accept(deleter);
         throw std::invalid_argument("something went wrong");
     }
 
@@ -309,123 +590,22 @@ inline AST_Node *Parser::NOT_Exp()
 
 inline AST_Node *Parser::COMPARE_Exp()
 {
-    AST_Node *node;
-
-    try
-    {
-        node = ADD_Exp();
-        Token token = current_token;
-
-        switch (token.t)
-        {
-        case Token::EQ:
-            eat(Token::EQ);
-            node = new Bin_OP(token, node, COMPARE_Exp());
-            break;
-        case Token::NEQ:
-            eat(Token::NEQ);
-            node = new Bin_OP(token, node, COMPARE_Exp());
-            break;
-        case Token::LESS:
-            eat(Token::LESS);
-            node = new Bin_OP(token, node, COMPARE_Exp());
-            break;
-        case Token::LESSEQ:
-            eat(Token::LESSEQ);
-            node = new Bin_OP(token, node, COMPARE_Exp());
-            break;
-        case Token::MORE:
-            eat(Token::MORE);
-            node = new Bin_OP(token, node, COMPARE_Exp());
-            break;
-        case Token::MOREEQ:
-            eat(Token::MOREEQ);
-            node = new Bin_OP(token, node, COMPARE_Exp());
-            break;
-        default:
-            break;
-        }
-    }
-    catch (...)
-    {
-        node->accept(deleter);
-        throw std::invalid_argument("something went wrong");
-    }
-
-    return node;
+    return chain(&Parser::ADD_Exp, {Token::EQ, Token::NEQ, Token::LESS, Token::LESSEQ, Token::MORE, Token::MOREEQ});
 };
 
 inline AST_Node *Parser::ADD_Exp()
 {
-    AST_Node *node;
-
-    try
-    {
-        node = MULT_Exp();
-        Token token = current_token;
-
-        switch (token.t)
-        {
-        case Token::PLUS:
-            eat(Token::PLUS);
-            node = new Bin_OP(token, node, ADD_Exp());
-            break;
-        case Token::MINUS:
-            eat(Token::MINUS);
-            node = new Bin_OP(token, node, ADD_Exp());
-            break;
-        default:
-            break;
-        }
-    }
-    catch (...)
-    {
-        node->accept(deleter);
-        throw std::invalid_argument("something went wrong");
-    }
-
-    return node;
+    return chain(&Parser::MULT_Exp, {Token::PLUS, Token::MINUS});
 };
 
 inline AST_Node *Parser::MULT_Exp()
 {
-    AST_Node *node;
-
-    try
-    {
-        node = NEGATE_Exp();
-        Token token = current_token;
-
-        switch (token.t)
-        {
-        case Token::MUL:
-            eat(Token::MUL);
-            node = new Bin_OP(token, node, MULT_Exp());
-            break;
-        case Token::DIV:
-            eat(Token::DIV);
-            node = new Bin_OP(token, node, MULT_Exp());
-            break;
-        case Token::MOD:
-            eat(Token::MOD);
-            node = new Bin_OP(token, node, MULT_Exp());
-            break;
-        default:
-            break;
-        }
-    }
-    catch (...)
-    {
-        node->accept(deleter);
-        throw std::invalid_argument("something went wrong");
-    }
-
-    return node;
+    return chain(&Parser::NEGATE_Exp, {Token::MUL, Token::DIV, Token::MOD});
 };
 
 inline AST_Node *Parser::NEGATE_Exp()
 {
-    AST_Node *node;
+    AST_Node *node = nullptr;
 
     try
     {
@@ -441,7 +621,8 @@ inline AST_Node *Parser::NEGATE_Exp()
     }
     catch (...)
     {
-        node->accept(deleter);
+        if (node)
+            node->accept(deleter);
         throw std::invalid_argument("something went wrong");
     }
 
@@ -450,7 +631,7 @@ inline AST_Node *Parser::NEGATE_Exp()
 
 inline AST_Node *Parser::Value()
 {
-    AST_Node *node;
+    AST_Node *node = nullptr;
 
     try
     {
@@ -474,10 +655,7 @@ inline AST_Node *Parser::Value()
             token = current_token;
             if (token.t == Token::SQ_LPAREN)
             {
-                //cout << "got here";
-                eat(Token::SQ_LPAREN);
-                node = new Array(name, Expression());
-                eat(Token::SQ_RPAREN);
+                node = new Array(name, Indices());
             }
             else
                 node = new Var(name);
@@ -487,20 +665,95 @@ inline AST_Node *Parser::Value()
             eat(Token::INTEGER);
             node = new Num(token);
             break;
+        case Token::SUM:
+        case Token::MAX:
+        case Token::MIN:
+        {
+            eat(token.t);
+            eat(Token::LPAREN);
+
+            Token arr = current_token;
+            eat(Token::ID);
+            eat(Token::COMMA);
+
+            node = new ArrReduce(token, arr, Expression());
+            eat(Token::RPAREN);
+            break;
+        }
+        case Token::DOT:
+        {
+            eat(Token::DOT);
+            eat(Token::LPAREN);
+
+            Token left = current_token;
+            eat(Token::ID);
+            eat(Token::COMMA);
+
+            Token right = current_token;
+            eat(Token::ID);
+            eat(Token::COMMA);
+
+            node = new ArrDot(left, right, Expression());
+            eat(Token::RPAREN);
+            break;
+        }
+        case Token::BSEARCH:
+        {
+            eat(Token::BSEARCH);
+            eat(Token::LPAREN);
+
+            Token arr = current_token;
+            eat(Token::ID);
+            eat(Token::COMMA);
+
+            //the search keeps the count in node until the key is parsed, so an error deletes both
+            ArrSearch *search = new ArrSearch(arr, Expression(), nullptr);
+            node = search;
+            eat(Token::COMMA);
+
+            search->key = Expression();
+            eat(Token::RPAREN);
+            break;
+        }
         default:
             //cout << "oops";
-            break;
+            error();
         }
     }
     catch (...)
     {
-        node->accept(deleter);
+        if (node)
+            node->accept(deleter);
         throw std::invalid_argument("something went wrong");
     }
 
     return node;
 };
 
+//one [expression] per dimension after an array name
+inline std::vector<AST_Node *> Parser::Indices()
+{
+    std::vector<AST_Node *> indices;
+
+    try
+    {
+        do
+        {
+            eat(Token::SQ_LPAREN);
+            indices.push_back(Expression());
+            eat(Token::SQ_RPAREN);
+        } while (current_token.t == Token::SQ_LPAREN);
+    }
+    catch (...)
+    {
+        for (int i = 0; i < indices.size(); ++i)
+            indices[i]->accept(deleter);
+        throw;
+    }
+
+    return indices;
+}
+
 inline AST_Node *Parser::parse()
 {
     return Program_Lines();
@@ -532,8 +785,8 @@ inline void Deleter::visit(Var *ast)
 
 inline void Deleter::visit(Array *ast)
 {
-    if (ast->index)
-        ast->index->accept(*this);
+    for (int i = 0; i < ast->indices.size(); ++i)
+        ast->indices[i]->accept(*this);
     delete ast;
 }
 
@@ -645,6 +898,138 @@ inline void Deleter::visit(ArrDecl *ast)
     delete ast;
 }
 
+inline void Deleter::visit(ArrReduce *ast)
+{
+    if (ast->count)
+        ast->count->accept(*this);
+    delete ast;
+}
+
+inline void Deleter::visit(ArrDot *ast)
+{
+    if (ast->count)
+        ast->count->accept(*this);
+    delete ast;
+}
+
+inline void Deleter::visit(ArrFill *ast)
+{
+    if (ast->expr)
+        ast->expr->accept(*this);
+    delete ast;
+}
+
+inline void Deleter::visit(ArrCopy *ast)
+{
+    delete ast;
+}
+
+inline void Deleter::visit(ArrSort *ast)
+{
+    if (ast->count)
+        ast->count->accept(*this);
+    delete ast;
+}
+
+inline void Deleter::visit(ArrFile *ast)
+{
+    if (ast->count)
+        ast->count->accept(*this);
+    delete ast;
+}
+
+inline void Deleter::visit(ForEach *ast)
+{
+    if (ast->bCode)
+        ast->bCode->accept(*this);
+    delete ast;
+}
+
+inline void Deleter::visit(ArrSearch *ast)
+{
+    if (ast->count)
+        ast->count->accept(*this);
+    if (ast->key)
+        ast->key->accept(*this);
+    delete ast;
+}
+
+inline void Deleter::visit(ParallelFor *ast)
+{
+    if (ast->from)
+        ast->from->accept(*this);
+    if (ast->to)
+        ast->to->accept(*this);
+    if (ast->bCode)
+        ast->bCode->accept(*this);
+
+    delete ast;
+}
+
+inline void Deleter::visit(Reduce *ast)
+{
+    if (ast->expr)
+        ast->expr->accept(*this);
+    if (ast->from)
+        ast->from->accept(*this);
+    if (ast->to)
+        ast->to->accept(*this);
+
+    delete ast;
+}
+
+inline void Deleter::visit(Spawn *ast)
+{
+    if (ast->expr)
+        ast->expr->accept(*this);
+    delete ast;
+}
+
+inline void Deleter::visit(Join *ast)
+{
+    delete ast;
+}
+
+inline void Deleter::visit(Yield *ast)
+{
+    delete ast;
+}
+
+inline void Deleter::visit(ChanDecl *ast)
+{
+    if (ast->capacity)
+        ast->capacity->accept(*this);
+    delete ast;
+}
+
+inline void Deleter::visit(Send *ast)
+{
+    if (ast->expr)
+        ast->expr->accept(*this);
+    delete ast;
+}
+
+inline void Deleter::visit(Recv *ast)
+{
+    if (ast->var)
+        ast->var->accept(*this);
+    if (ast->arr)
+        ast->arr->accept(*this);
+    delete ast;
+}
+
+inline void Deleter::visit(AtomicOp *ast)
+{
+    if (ast->arr)
+        ast->arr->accept(*this);
+    if (ast->expr)
+        ast->expr->accept(*this);
+    if (ast->desired)
+        ast->desired->accept(*this);
+
+    delete ast;
+}
+
 inline void Deleter::visit(NO_OP *ast)
 {
     delete ast;
@@ -0,0 +1,58 @@
+#pragma once
+
+#ifndef PERF_COUNTERS_HEADER
+#define PERF_COUNTERS_HEADER
+
+#include <chrono>
+#include <ostream>
+#include <string>
+#include <vector>
+
+struct PhaseCounters
+{
+    enum event
+    {
+        CYCLES,
+        INSTRUCTIONS,
+        BRANCH_MISSES,
+        CACHE_MISSES,
+        EVENT_COUNT
+    };
+
+    std::string phase;
+    double wall_ms;
+
+    //counts[i] is meaningful only when valid[i] is set
+    unsigned long long counts[EVENT_COUNT];
+    bool valid[EVENT_COUNT];
+};
+
+////PERF COUNTERS////
+//opens one group of Linux perf_event counters for the calling thread (user space only);
+//when the kernel refuses them every phase still gets its wall-clock time
+class PerfCounters
+{
+public:
+    PerfCounters();
+    ~PerfCounters();
+
+    PerfCounters(const PerfCounters &) = delete;
+    PerfCounters &operator=(const PerfCounters &) = delete;
+
+    bool available() const;
+
+    void start();
+    PhaseCounters stop(const std::string &phase);
+
+    static void write_report(std::ostream &report, const std::vector<PhaseCounters> &phases);
+
+private:
+    int fds[PhaseCounters::EVENT_COUNT];
+    std::chrono::steady_clock::time_point started;
+
+    int open_event(unsigned type, unsigned long long config, int group);
+};
+
+#include "perf_counters.inl"
+
+#endif
\ No newline at end of file
@@ -0,0 +1,120 @@
+#ifndef PERF_COUNTERS_SOURCE
+#define PERF_COUNTERS_SOURCE
+
+#include <cstring>
+#include <iomanip>
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+inline PerfCounters::PerfCounters()
+{
+    //the cycle counter leads the group, so all of them are started and stopped together
+    fds[PhaseCounters::CYCLES] = open_event(PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES, -1);
+
+    for (int i = PhaseCounters::INSTRUCTIONS; i < PhaseCounters::EVENT_COUNT; ++i)
+        fds[i] = -1;
+
+    if (!available())
+        return;
+
+    fds[PhaseCounters::INSTRUCTIONS] = open_event(PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS, fds[PhaseCounters::CYCLES]);
+    fds[PhaseCounters::BRANCH_MISSES] = open_event(PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES, fds[PhaseCounters::CYCLES]);
+    fds[PhaseCounters::CACHE_MISSES] = open_event(PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES, fds[PhaseCounters::CYCLES]);
+}
+
+inline PerfCounters::~PerfCounters()
+{
+    for (int i = 0; i < PhaseCounters::EVENT_COUNT; ++i)
+    {
+        if (fds[i] >= 0)
+            close(fds[i]);
+    }
+}
+
+inline int PerfCounters::open_event(unsigned type, unsigned long long config, int group)
+{
+    struct perf_event_attr attr;
+    std::memset(&attr, 0, sizeof(attr));
+    attr.size = sizeof(attr);
+    attr.type = type;
+    attr.config = config;
+    attr.disabled = group < 0; //members follow the leader
+    attr.exclude_kernel = 1;
+    attr.exclude_hv = 1;
+
+    return (int)syscall(__NR_perf_event_open, &attr, 0, -1, group, 0);
+}
+
+inline bool PerfCounters::available() const
+{
+    return fds[PhaseCounters::CYCLES] >= 0;
+}
+
+inline void PerfCounters::start()
+{
+    if (available())
+    {
+        ioctl(fds[PhaseCounters::CYCLES], PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+        ioctl(fds[PhaseCounters::CYCLES], PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+    }
+
+    started = std::chrono::steady_clock::now();
+}
+
+inline PhaseCounters PerfCounters::stop(const std::string &phase)
+{
+    std::chrono::steady_clock::time_point stopped = std::chrono::steady_clock::now();
+
+    if (available())
+        ioctl(fds[PhaseCounters::CYCLES], PERF_EVENT_IOC_DISABLE, PERF_IOC_FLAG_GROUP);
+
+    PhaseCounters result;
+    result.phase = phase;
+    result.wall_ms = std::chrono::duration<double, std::milli>(stopped - started).count();
+
+    for (int i = 0; i < PhaseCounters::EVENT_COUNT; ++i)
+    {
+        result.counts[i] = 0;
+        result.valid[i] = fds[i] >= 0 && read(fds[i], &result.counts[i], sizeof(result.counts[i])) == sizeof(result.counts[i]);
+    }
+
+    return result;
+}
+
+inline void PerfCounters::write_report(std::ostream &report, const std::vector<PhaseCounters> &phases)
+{
+    static const char *names[PhaseCounters::EVENT_COUNT] = {"cycles", "instructions", "branch-miss", "cache-miss"};
+
+    report << std::left << std::setw(12) << "phase" << std::right << std::setw(12) << "wall ms";
+    for (int i = 0; i < PhaseCounters::EVENT_COUNT; ++i)
+        report << std::setw(16) << names[i];
+    report << std::setw(8) << "IPC" << "\n";
+
+    for (int p = 0; p < phases.size(); ++p)
+    {
+        const PhaseCounters &phase = phases[p];
+
+        report << std::left << std::setw(12) << phase.phase << std::right << std::setw(12) << std::fixed
+               << std::setprecision(3) << phase.wall_ms;
+
+        for (int i = 0; i < PhaseCounters::EVENT_COUNT; ++i)
+        {
+            if (phase.valid[i])
+                report << std::setw(16) << phase.counts[i];
+            else
+                report << std::setw(16) << "n/a";
+        }
+
+        if (phase.valid[PhaseCounters::CYCLES] && phase.valid[PhaseCounters::INSTRUCTIONS] && phase.counts[PhaseCounters::CYCLES])
+            report << std::setw(8) << std::setprecision(2)
+                   << (double)phase.counts[PhaseCounters::INSTRUCTIONS] / phase.counts[PhaseCounters::CYCLES];
+        else
+            report << std::setw(8) << "n/a";
+
+        report << "\n";
+    }
+}
+
+#endif
\ No newline at end of file
@@ -0,0 +1,56 @@
+#pragma once
+
+#ifndef PROFILER_HEADER
+#define PROFILER_HEADER
+
+#include <chrono>
+#include <ostream>
+
+#include "program.h"
+
+struct StatementStats
+{
+    int line;
+    long long executions;
+    long long total_ns; //including the statements nested inside
+    long long self_ns;
+};
+
+struct LoopStats
+{
+    int line;
+    long long entries;
+    long long iterations;
+    long long total_ns;
+};
+
+////PROFILING INTERPRETER////
+//counts and times every statement it executes; the plain Interpreter is left untouched,
+//so programs that are not profiled don't pay for any of this
+class ProfilingInterpreter : public Interpreter
+{
+private:
+    std::unordered_map<AST_Node *, StatementStats> statements;
+    std::unordered_map<AST_Node *, LoopStats> loops;
+
+    //body block of every loop seen so far, the body runs once per iteration
+    std::unordered_map<AST_Node *, AST_Node *> loop_bodies;
+
+    //time spent in nested statements, one entry per statement that is currently running
+    std::vector<long long> child_time;
+
+    static long long now_ns();
+
+public:
+    using Interpreter::visit;
+
+    void visit(BlockCode *ast);
+    void visit(While *ast);
+
+    //hot lines sorted by self time, the loops, and the source with counts and times next to every line
+    void write_report(std::ostream &report, const std::string &source) const;
+};
+
+#include "profiler.inl"
+
+#endif
\ No newline at end of file
@@ -0,0 +1,149 @@
+#ifndef PROFILER_SOURCE
+#define PROFILER_SOURCE
+
+#include <algorithm>
+#include <iomanip>
+#include <map>
+#include <sstream>
+
+inline long long ProfilingInterpreter::now_ns()
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+inline void ProfilingInterpreter::visit(BlockCode *ast)
+{
+    std::unordered_map<AST_Node *, AST_Node *>::const_iterator body = loop_bodies.find(ast);
+    if (body != loop_bodies.end())
+        ++loops[body->second].iterations;
+
+    for (int i = 0; i < ast->statements.size(); ++i)
+    {
+        AST_Node *statement = ast->statements[i];
+
+        //statements passed over while looking for a label are not executed, empty lines have no position
+        if (skip_mode || statement->line == 0)
+        {
+            statement->accept(*this);
+            continue;
+        }
+
+        child_time.push_back(0);
+        long long start = now_ns();
+
+        statement->accept(*this);
+
+        long long elapsed = now_ns() - start;
+        long long nested = child_time.back();
+        child_time.pop_back();
+
+        StatementStats &stats = statements[statement];
+        stats.line = statement->line;
+        ++stats.executions;
+        stats.total_ns += elapsed;
+        stats.self_ns += elapsed - nested;
+
+        if (!child_time.empty())
+            child_time.back() += elapsed;
+    }
+}
+
+inline void ProfilingInterpreter::visit(While *ast)
+{
+    if (skip_mode)
+        return;
+
+    LoopStats &stats = loops[ast];
+    stats.line = ast->line;
+    ++stats.entries;
+    loop_bodies[ast->bCode] = ast;
+
+    long long start = now_ns();
+    Interpreter::visit(ast);
+    loops[ast].total_ns += now_ns() - start;
+}
+
+inline void ProfilingInterpreter::write_report(std::ostream &report, const std::string &source) const
+{
+    std::vector<std::string> source_lines;
+    std::istringstream lines(source);
+    std::string text;
+    while (getline(lines, text))
+    {
+        if (!text.empty() && text.back() == '\r')
+            text.pop_back();
+        source_lines.push_back(text);
+    }
+
+    //there is only one statement per line, but merge by line anyway so the listing can index it directly
+    std::map<int, StatementStats> by_line;
+    long long program_ns = 0;
+    for (std::unordered_map<AST_Node *, StatementStats>::const_iterator it = statements.begin(); it != statements.end(); ++it)
+    {
+        StatementStats &line = by_line[it->second.line];
+        line.line = it->second.line;
+        line.executions += it->second.executions;
+        line.total_ns += it->second.total_ns;
+        line.self_ns += it->second.self_ns;
+        program_ns += it->second.self_ns;
+    }
+
+    std::vector<StatementStats> hot;
+    for (std::map<int, StatementStats>::const_iterator it = by_line.begin(); it != by_line.end(); ++it)
+        hot.push_back(it->second);
+
+    std::sort(hot.begin(), hot.end(), [](const StatementStats &a, const StatementStats &b) {
+        return a.self_ns != b.self_ns ? a.self_ns > b.self_ns : a.line < b.line;
+    });
+
+    report << std::fixed << std::setprecision(3);
+
+    report << "HOT LINES (by self time)\n";
+    report << std::setw(6) << "line" << std::setw(12) << "count" << std::setw(12) << "self ms"
+           << std::setw(12) << "total ms" << std::setw(8) << "self%" << "  source\n";
+    for (int i = 0; i < hot.size(); ++i)
+    {
+        double percent = program_ns ? 100.0 * hot[i].self_ns / program_ns : 0.0;
+        std::string code = hot[i].line > 0 && hot[i].line <= source_lines.size() ? source_lines[hot[i].line - 1] : "";
+
+        report << std::setw(6) << hot[i].line << std::setw(12) << hot[i].executions
+               << std::setw(12) << hot[i].self_ns / 1e6 << std::setw(12) << hot[i].total_ns / 1e6
+               << std::setw(7) << std::setprecision(1) << percent << "%" << std::setprecision(3)
+               << "  " << code << "\n";
+    }
+
+    std::vector<LoopStats> loop_list;
+    for (std::unordered_map<AST_Node *, LoopStats>::const_iterator it = loops.begin(); it != loops.end(); ++it)
+        loop_list.push_back(it->second);
+
+    std::sort(loop_list.begin(), loop_list.end(), [](const LoopStats &a, const LoopStats &b) {
+        return a.total_ns != b.total_ns ? a.total_ns > b.total_ns : a.line < b.line;
+    });
+
+    report << "\nLOOPS\n";
+    report << std::setw(6) << "line" << std::setw(12) << "entries" << std::setw(12) << "iterations"
+           << std::setw(12) << "total ms" << std::setw(12) << "avg iter" << "\n";
+    for (int i = 0; i < loop_list.size(); ++i)
+    {
+        double average = loop_list[i].entries ? (double)loop_list[i].iterations / loop_list[i].entries : 0.0;
+
+        report << std::setw(6) << loop_list[i].line << std::setw(12) << loop_list[i].entries
+               << std::setw(12) << loop_list[i].iterations << std::setw(12) << loop_list[i].total_ns / 1e6
+               << std::setw(12) << std::setprecision(1) << average << std::setprecision(3) << "\n";
+    }
+
+    report << "\nLISTING\n";
+    report << std::setw(12) << "count" << std::setw(12) << "self ms" << "  line\n";
+    for (int i = 0; i < source_lines.size(); ++i)
+    {
+        std::map<int, StatementStats>::const_iterator got = by_line.find(i + 1);
+        if (got != by_line.end())
+            report << std::setw(12) << got->second.executions << std::setw(12) << got->second.self_ns / 1e6;
+        else
+            report << std::setw(12) << "" << std::setw(12) << "";
+
+        report << std::setw(6) << i + 1 << "  " << source_lines[i] << "\n";
+    }
+}
+
+#endif
\ No newline at end of file
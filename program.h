@@ -0,0 +1,54 @@
+#pragma once
+
+#ifndef PROGRAM_HEADER
+#define PROGRAM_HEADER
+
+#include <string_view>
+
+#include "interpreter.h"
+
+////COMPILED PROGRAM////
+//a parsed tree together with its labels and the loops that can run in parallel; it is never modified while running,
+//so one compiled program can be executed by many contexts, also concurrently
+class CompiledProgram
+{
+private:
+    AST_Node *tree;
+    std::unordered_set<std::string> label_set;
+    LoopAnalyzer analysis;
+
+    CompiledProgram(AST_Node *t);
+
+    friend CompiledProgram compile(std::string_view source);
+
+public:
+    CompiledProgram(CompiledProgram &&other);
+    CompiledProgram &operator=(CompiledProgram &&other);
+    ~CompiledProgram();
+
+    CompiledProgram(const CompiledProgram &) = delete;
+    CompiledProgram &operator=(const CompiledProgram &) = delete;
+
+    AST_Node *root() const;
+    const std::unordered_set<std::string> &labels() const;
+    const LoopAnalyzer &loops() const;
+};
+
+////EXECUTION CONTEXT////
+//keeps the interpreter state between runs so repeated executions reuse its allocations
+class ExecutionContext
+{
+private:
+    Interpreter interpreter;
+
+public:
+    void run(const CompiledProgram &program, InputSource &input, OutputSink &output);
+};
+
+CompiledProgram compile(std::string_view source);
+
+void run(const CompiledProgram &program, InputSource &input, OutputSink &output);
+
+#include "program.inl"
+
+#endif
\ No newline at end of file
@@ -0,0 +1,81 @@
+#ifndef PROGRAM_SOURCE
+#define PROGRAM_SOURCE
+
+inline CompiledProgram::CompiledProgram(AST_Node *t) : tree(t)
+{
+    BeforeInterpret b;
+    tree->accept(b);
+    label_set = b.labels;
+
+    tree->accept(analysis);
+}
+
+inline CompiledProgram::CompiledProgram(CompiledProgram &&other)
+    : tree(other.tree), label_set(std::move(other.label_set)), analysis(std::move(other.analysis))
+{
+    other.tree = nullptr;
+}
+
+inline CompiledProgram &CompiledProgram::operator=(CompiledProgram &&other)
+{
+    if (this != &other)
+    {
+        if (tree)
+        {
+            Deleter deleter;
+            tree->accept(deleter);
+        }
+
+        tree = other.tree;
+        label_set = std::move(other.label_set);
+        analysis = std::move(other.analysis);
+        other.tree = nullptr;
+    }
+
+    return *this;
+}
+
+inline CompiledProgram::~CompiledProgram()
+{
+    if (tree)
+    {
+        Deleter deleter;
+        tree->accept(deleter);
+    }
+}
+
+inline AST_Node *CompiledProgram::root() const
+{
+    return tree;
+}
+
+inline const std::unordered_set<std::string> &CompiledProgram::labels() const
+{
+    return label_set;
+}
+
+inline const LoopAnalyzer &CompiledProgram::loops() const
+{
+    return analysis;
+}
+
+inline void ExecutionContext::run(const CompiledProgram &program, InputSource &input, OutputSink &output)
+{
+    interpreter.execute(program.root(), program.labels(), input, output, &program.loops().loops);
+}
+
+inline CompiledProgram compile(std::string_view source)
+{
+    Lexer lexer{std::string(source)};
+    Parser parser(lexer);
+
+    return CompiledProgram(parser.parse());
+}
+
+inline void run(const CompiledProgram &program, InputSource &input, OutputSink &output)
+{
+    ExecutionContext context;
+    context.run(program, input, output);
+}
+
+#endif
\ No newline at end of file
@@ -0,0 +1,132 @@
+#pragma once
+
+#ifndef PROGRAM_IO_HEADER
+#define PROGRAM_IO_HEADER
+
+#include <iostream>
+#include <mutex>
+#include <string>
+
+#include "value.h"
+
+////INPUT SOURCES////
+//READ pulls one line at a time, the interpreter parses the line as an expression
+class InputSource
+{
+public:
+    virtual ~InputSource() {}
+
+    //returns false when there is no more input
+    virtual bool read_line(std::string &line) = 0;
+};
+
+////OUTPUT SINKS////
+class OutputSink
+{
+public:
+    virtual ~OutputSink() {}
+
+    virtual void write_value(value_t value) = 0;
+    virtual void flush() {}
+};
+
+//stdin with the "> " prompt used by the interactive modes
+class ConsoleInput : public InputSource
+{
+private:
+    const char *prompt;
+
+public:
+    ConsoleInput(const char *_prompt = "> ");
+    bool read_line(std::string &line);
+};
+
+class ConsoleOutput : public OutputSink
+{
+public:
+    void write_value(value_t value);
+    void flush();
+};
+
+class StreamInput : public InputSource
+{
+private:
+    std::istream &stream;
+
+public:
+    StreamInput(std::istream &_stream);
+    bool read_line(std::string &line);
+};
+
+class StreamOutput : public OutputSink
+{
+private:
+    std::ostream &stream;
+
+public:
+    StreamOutput(std::ostream &_stream);
+    void write_value(value_t value);
+    void flush();
+};
+
+//in-memory input, reset() rewinds it so the same data can feed another run
+class StringInput : public InputSource
+{
+private:
+    std::string text;
+    std::size_t pos;
+
+public:
+    StringInput(std::string _text = "");
+    bool read_line(std::string &line);
+    void reset(std::string _text);
+};
+
+class StringOutput : public OutputSink
+{
+private:
+    std::string text;
+
+public:
+    void write_value(value_t value);
+    const std::string &str() const;
+    void clear();
+};
+
+//discards everything, for runs where only the side effects or the timing matter
+class NullOutput : public OutputSink
+{
+public:
+    void write_value(value_t value);
+};
+
+//share one source or sink between code running on several threads, every line goes through the lock
+class LockedInput : public InputSource
+{
+private:
+    InputSource &inner;
+    std::mutex &lock;
+
+public:
+    LockedInput(InputSource &_inner, std::mutex &_lock);
+    bool read_line(std::string &line);
+};
+
+class LockedOutput : public OutputSink
+{
+private:
+    OutputSink &inner;
+    std::mutex &lock;
+
+public:
+    LockedOutput(OutputSink &_inner, std::mutex &_lock);
+    void write_value(value_t value);
+    void flush();
+};
+
+InputSource &console_input();
+OutputSink &console_output();
+
+#include "program_io.inl"
+
+#endif
\ No newline at end of file
@@ -0,0 +1,131 @@
+#ifndef PROGRAM_IO_SOURCE
+#define PROGRAM_IO_SOURCE
+
+inline ConsoleInput::ConsoleInput(const char *_prompt) : prompt(_prompt)
+{
+}
+
+inline bool ConsoleInput::read_line(std::string &line)
+{
+    std::cout << prompt;
+    return (bool)getline(std::cin, line);
+}
+
+inline void ConsoleOutput::write_value(value_t value)
+{
+    std::cout << value << std::endl;
+}
+
+inline void ConsoleOutput::flush()
+{
+    std::cout.flush();
+}
+
+inline StreamInput::StreamInput(std::istream &_stream) : stream(_stream)
+{
+}
+
+inline bool StreamInput::read_line(std::string &line)
+{
+    return (bool)getline(stream, line);
+}
+
+inline StreamOutput::StreamOutput(std::ostream &_stream) : stream(_stream)
+{
+}
+
+inline void StreamOutput::write_value(value_t value)
+{
+    stream << value << '\n';
+}
+
+inline void StreamOutput::flush()
+{
+    stream.flush();
+}
+
+inline StringInput::StringInput(std::string _text) : text(_text), pos(0)
+{
+}
+
+inline bool StringInput::read_line(std::string &line)
+{
+    if (pos >= text.size())
+        return false;
+
+    std::size_t end = text.find('\n', pos);
+    if (end == std::string::npos)
+        end = text.size();
+
+    line.assign(text, pos, end - pos);
+    pos = end + 1;
+
+    return true;
+}
+
+inline void StringInput::reset(std::string _text)
+{
+    text = _text;
+    pos = 0;
+}
+
+inline void StringOutput::write_value(value_t value)
+{
+    text += value_to_string(value);
+    text.push_back('\n');
+}
+
+inline const std::string &StringOutput::str() const
+{
+    return text;
+}
+
+inline void StringOutput::clear()
+{
+    text.clear();
+}
+
+inline void NullOutput::write_value(value_t value)
+{
+}
+
+inline LockedInput::LockedInput(InputSource &_inner, std::mutex &_lock) : inner(_inner), lock(_lock)
+{
+}
+
+inline bool LockedInput::read_line(std::string &line)
+{
+    std::lock_guard<std::mutex> guard(lock);
+    return inner.read_line(line);
+}
+
+inline LockedOutput::LockedOutput(OutputSink &_inner, std::mutex &_lock) : inner(_inner), lock(_lock)
+{
+}
+
+inline void LockedOutput::write_value(value_t value)
+{
+    std::lock_guard<std::mutex> guard(lock);
+    inner.write_value(value);
+}
+
+inline void LockedOutput::flush()
+{
+    std::lock_guard<std::mutex> guard(lock);
+    inner.flush();
+}
+
+//the console ones keep no state, so every interpreter can share them
+inline InputSource &console_input()
+{
+    static ConsoleInput input;
+    return input;
+}
+
+inline OutputSink &console_output()
+{
+    static ConsoleOutput output;
+    return output;
+}
+
+#endif
\ No newline at end of file
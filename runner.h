@@ -0,0 +1,41 @@
+#pragma once
+
+#ifndef RUNNER_HEADER
+#define RUNNER_HEADER
+
+#include "program.h"
+#include "thread_pool.h"
+
+//one independent execution: the program text and everything its READ statements will consume
+struct RunJob
+{
+    std::string program;
+    std::string input;
+};
+
+struct RunResult
+{
+    bool ok;
+    std::string output;
+    std::string error; //filled only when ok is false
+};
+
+////PROGRAM RUNNER////
+//executes many programs concurrently, each with its own Interpreter and in-memory streams
+class ProgramRunner
+{
+private:
+    ThreadPool &pool;
+
+public:
+    ProgramRunner(ThreadPool &_pool);
+
+    static RunResult run_one(const RunJob &job);
+
+    //results come back in the same order as the jobs were given
+    std::vector<RunResult> run_all(const std::vector<RunJob> &jobs);
+};
+
+#include "runner.inl"
+
+#endif
\ No newline at end of file
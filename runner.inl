@@ -0,0 +1,54 @@
+#ifndef RUNNER_SOURCE
+#define RUNNER_SOURCE
+
+inline ProgramRunner::ProgramRunner(ThreadPool &_pool) : pool(_pool)
+{
+}
+
+inline RunResult ProgramRunner::run_one(const RunJob &job)
+{
+    //every worker thread keeps one context, so its scopes are reused across jobs
+    static thread_local ExecutionContext context;
+
+    StringInput input(job.input);
+    StringOutput output;
+
+    RunResult result;
+    result.ok = true;
+
+    try
+    {
+        CompiledProgram program = compile(job.program);
+        context.run(program, input, output);
+    }
+    catch (const std::exception &e)
+    {
+        result.ok = false;
+        result.error = e.what();
+    }
+
+    result.output = output.str();
+    return result;
+}
+
+inline std::vector<RunResult> ProgramRunner::run_all(const std::vector<RunJob> &jobs)
+{
+    std::vector<std::future<RunResult>> pending;
+    pending.reserve(jobs.size());
+
+    for (std::size_t i = 0; i < jobs.size(); ++i)
+    {
+        const RunJob *job = &jobs[i];
+        pending.push_back(pool.submit([job]() { return run_one(*job); }));
+    }
+
+    std::vector<RunResult> results;
+    results.reserve(jobs.size());
+
+    for (std::size_t i = 0; i < pending.size(); ++i)
+        results.push_back(pool.wait(pending[i]));
+
+    return results;
+}
+
+#endif
\ No newline at end of file
@@ -0,0 +1,80 @@
+#pragma once
+
+#ifndef SAMPLER_HEADER
+#define SAMPLER_HEADER
+
+#include <csignal>
+#include <ctime>
+#include <ostream>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include "program.h"
+
+//glibc's sigevent has the field but not the name the kernel headers give it
+#ifndef sigev_notify_thread_id
+#define sigev_notify_thread_id _sigev_un._tid
+#endif
+
+////SAMPLING INTERPRETER////
+//keeps a small stack with the line of the running statement and the lines of the WHILE/IF statements
+//around it; samples of that stack are taken by a SIGPROF timer or every N executed statements
+//and written as collapsed stacks ("frame;frame;frame count") for flame graph tools.
+//the timer counts the CPU time of the whole process but sends its signal only to the thread that called start(),
+//so the handler never runs on the pool's threads while PARALLEL FOR, REDUCE or SORT keep them busy
+class SamplingInterpreter : public Interpreter
+{
+public:
+    enum Trigger
+    {
+        TIMER,     //period is in microseconds of CPU time
+        STATEMENTS //period is a number of executed statements
+    };
+
+    static const int MAX_DEPTH = 64;
+
+    SamplingInterpreter(Trigger _trigger, long _period, std::size_t max_samples = 100000);
+
+    using Interpreter::visit;
+
+    void visit(BlockCode *ast);
+    void visit(IfElse *ast);
+    void visit(While *ast);
+
+    void start();
+    void stop();
+
+    long long samples_taken() const;
+    long long samples_dropped() const;
+
+    void write_collapsed(std::ostream &folded, const std::string &source) const;
+
+private:
+    Trigger trigger;
+    long period;
+
+    //written by the interpreter, read by the signal handler on the same thread
+    int frames[MAX_DEPTH];
+    volatile sig_atomic_t depth;
+
+    long long statement_count;
+
+    //every sample is MAX_DEPTH + 1 ints: the number of frames followed by the frames
+    std::vector<int> samples;
+    std::size_t capacity;
+    volatile sig_atomic_t taken;
+    volatile sig_atomic_t dropped;
+
+    struct sigaction previous_action;
+    timer_t timer;
+    bool timing; //the timer was created
+
+    void take_sample();
+
+    static SamplingInterpreter *&active();
+    static void on_signal(int, siginfo_t *info, void *);
+};
+
+#include "sampler.inl"
+
+#endif
\ No newline at end of file
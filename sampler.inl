@@ -0,0 +1,188 @@
+#ifndef SAMPLER_SOURCE
+#define SAMPLER_SOURCE
+
+#include <map>
+#include <sstream>
+
+inline SamplingInterpreter::SamplingInterpreter(Trigger _trigger, long _period, std::size_t max_samples)
+    : trigger(_trigger), period(_period > 0 ? _period : 1), depth(0), statement_count(0),
+      samples(max_samples * (MAX_DEPTH + 1)), capacity(max_samples), taken(0), dropped(0), timing(false)
+{
+    frames[0] = 0;
+}
+
+inline SamplingInterpreter *&SamplingInterpreter::active()
+{
+    static SamplingInterpreter *sampler = nullptr;
+    return sampler;
+}
+
+//expirations that came while the signal was still pending are only counted in si_overrun,
+//every one of them stands for the same stack
+inline void SamplingInterpreter::on_signal(int, siginfo_t *info, void *)
+{
+    if (!active())
+        return;
+
+    int count = info->si_code == SI_TIMER ? info->si_overrun + 1 : 1;
+    for (int i = 0; i < count; ++i)
+        active()->take_sample();
+}
+
+//only touches preallocated memory, so it is safe to call from the signal handler
+inline void SamplingInterpreter::take_sample()
+{
+    if ((std::size_t)taken >= capacity)
+    {
+        dropped = dropped + 1;
+        return;
+    }
+
+    int frame_count = depth < MAX_DEPTH ? depth + 1 : MAX_DEPTH;
+    int *sample = &samples[taken * (MAX_DEPTH + 1)];
+
+    sample[0] = frame_count;
+    for (int i = 0; i < frame_count; ++i)
+        sample[i + 1] = frames[i];
+
+    taken = taken + 1;
+}
+
+inline void SamplingInterpreter::start()
+{
+    if (trigger != TIMER)
+        return;
+
+    active() = this;
+
+    struct sigaction action;
+    action.sa_sigaction = &SamplingInterpreter::on_signal;
+    sigemptyset(&action.sa_mask);
+    action.sa_flags = SA_RESTART | SA_SIGINFO; //SA_RESTART: READ keeps waiting for input instead of failing with EINTR
+    sigaction(SIGPROF, &action, &previous_action);
+
+    struct sigevent event = {};
+    event.sigev_notify = SIGEV_THREAD_ID;
+    event.sigev_signo = SIGPROF;
+    event.sigev_notify_thread_id = syscall(SYS_gettid);
+    timing = timer_create(CLOCK_PROCESS_CPUTIME_ID, &event, &timer) == 0;
+    if (!timing)
+        return;
+
+    struct itimerspec interval;
+    interval.it_interval.tv_sec = period / 1000000;
+    interval.it_interval.tv_nsec = period % 1000000 * 1000;
+    interval.it_value = interval.it_interval;
+    timer_settime(timer, 0, &interval, nullptr);
+}
+
+inline void SamplingInterpreter::stop()
+{
+    if (trigger != TIMER)
+        return;
+
+    if (timing)
+        timer_delete(timer);
+    timing = false;
+    sigaction(SIGPROF, &previous_action, nullptr);
+
+    active() = nullptr;
+}
+
+inline long long SamplingInterpreter::samples_taken() const
+{
+    return taken;
+}
+
+inline long long SamplingInterpreter::samples_dropped() const
+{
+    return dropped;
+}
+
+inline void SamplingInterpreter::visit(BlockCode *ast)
+{
+    for (int i = 0; i < ast->statements.size(); ++i)
+    {
+        AST_Node *statement = ast->statements[i];
+
+        if (depth < MAX_DEPTH)
+            frames[depth] = statement->line;
+
+        if (trigger == STATEMENTS && !skip_mode && statement->line && ++statement_count % period == 0)
+            take_sample();
+
+        statement->accept(*this);
+    }
+
+    //a WHILE condition evaluated after its body is attributed to the WHILE line itself
+    if (depth < MAX_DEPTH)
+        frames[depth] = 0;
+}
+
+//the frame of the IF/WHILE itself is already on the stack, its body goes one level deeper
+
+inline void SamplingInterpreter::visit(IfElse *ast)
+{
+    std::atomic_signal_fence(std::memory_order_seq_cst);
+    depth = depth + 1;
+
+    Interpreter::visit(ast);
+
+    depth = depth - 1;
+    std::atomic_signal_fence(std::memory_order_seq_cst);
+}
+
+inline void SamplingInterpreter::visit(While *ast)
+{
+    std::atomic_signal_fence(std::memory_order_seq_cst);
+    depth = depth + 1;
+
+    Interpreter::visit(ast);
+
+    depth = depth - 1;
+    std::atomic_signal_fence(std::memory_order_seq_cst);
+}
+
+inline void SamplingInterpreter::write_collapsed(std::ostream &folded, const std::string &source) const
+{
+    std::vector<std::string> source_lines;
+    std::istringstream lines(source);
+    std::string text;
+    while (getline(lines, text))
+    {
+        //';' separates frames and the last space separates the count, so neither may appear inside a frame
+        for (int i = 0; i < text.size(); ++i)
+        {
+            if (text[i] == ';' || text[i] == '\r' || text[i] == '\t')
+                text[i] = ' ';
+        }
+
+        std::size_t begin = text.find_first_not_of(' ');
+        std::size_t end = text.find_last_not_of(' ');
+        source_lines.push_back(begin == std::string::npos ? "" : text.substr(begin, end - begin + 1));
+    }
+
+    std::map<std::string, long long> stacks;
+    for (long long s = 0; s < taken; ++s)
+    {
+        const int *sample = &samples[s * (MAX_DEPTH + 1)];
+
+        std::string stack = "program";
+        for (int i = 1; i <= sample[0]; ++i)
+        {
+            int line = sample[i];
+            if (line <= 0)
+                continue;
+
+            stack += ";" + std::to_string(line) + ": ";
+            stack += line <= source_lines.size() ? source_lines[line - 1] : "";
+        }
+
+        ++stacks[stack];
+    }
+
+    for (std::map<std::string, long long>::const_iterator it = stacks.begin(); it != stacks.end(); ++it)
+        folded << it->first << " " << it->second << "\n";
+}
+
+#endif
\ No newline at end of file
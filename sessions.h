@@ -0,0 +1,107 @@
+#pragma once
+
+#ifndef SESSIONS_HEADER
+#define SESSIONS_HEADER
+
+#include <atomic>
+#include <memory>
+#include <string>
+#include <system_error>
+#include <unordered_map>
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include "program.h"
+#include "thread_pool.h"
+
+////INTERACTIVE SESSIONS////
+//serves one program to many clients at once. every connection runs the program as a green thread task;
+//a READ that finds no complete line parks the task until epoll reports the socket again, so waiting
+//sessions cost no thread and thousands of them share the scheduler's few threads
+
+//a client that sends more than this without a newline is dropped instead of being buffered for good
+static const std::size_t SESSION_LINE_LIMIT = 64 * 1024;
+
+//one client connection, the task reads and writes it, the event loop only bumps events
+struct Session
+{
+    int fd;
+    std::atomic<std::size_t> events; //readiness edges seen by the event loop, the task parks on it
+    std::atomic<bool> finished;
+
+    std::string received;
+    std::size_t consumed; //the part of received that READ already took
+    bool closed;          //the client shut down its side
+
+    std::string outgoing;
+    bool broken; //sending failed, the rest of the output is dropped
+
+    explicit Session(int _fd);
+};
+
+class SessionInput : public InputSource
+{
+private:
+    Session &session;
+
+public:
+    SessionInput(Session &_session);
+    //sends the pending output first, so a client sees everything printed before it is asked for input.
+    //a line longer than SESSION_LINE_LIMIT ends the session's program
+    bool read_line(std::string &line);
+};
+
+class SessionOutput : public OutputSink
+{
+private:
+    Session &session;
+
+public:
+    SessionOutput(Session &_session);
+    void write_value(value_t value);
+    void write_text(const std::string &text);
+    void flush();
+};
+
+class SessionServer
+{
+public:
+    //listens on localhost, port 0 picks a free port
+    SessionServer(const CompiledProgram &_program, int port);
+    ~SessionServer();
+
+    SessionServer(const SessionServer &) = delete;
+    SessionServer &operator=(const SessionServer &) = delete;
+
+    int port() const;
+
+    //serves until stop() is called; the tasks run between two epoll waits
+    void run();
+    //can be called from any thread
+    void stop();
+
+private:
+    const CompiledProgram &program;
+    int listener;
+    int epoll;
+    int stopper; //an eventfd that wakes the loop for stop()
+    int bound_port;
+    bool stopping;
+
+    std::unordered_map<int, std::unique_ptr<Session>> open;
+    //destroyed before the sessions, the cancelled tasks still see theirs while they unwind
+    TaskScheduler scheduler;
+
+    void accept_all();
+    void start(Session *session);
+    void close_finished();
+};
+
+#include "sessions.inl"
+
+#endif
\ No newline at end of file
@@ -0,0 +1,276 @@
+#ifndef SESSIONS_SOURCE
+#define SESSIONS_SOURCE
+
+inline Session::Session(int _fd)
+    : fd(_fd), events(0), finished(false), consumed(0), closed(false), broken(false)
+{
+}
+
+inline SessionInput::SessionInput(Session &_session) : session(_session)
+{
+}
+
+//the counter is read before every attempt, so an edge that comes after a failed recv wakes the task
+inline bool SessionInput::read_line(std::string &line)
+{
+    while (true)
+    {
+        std::size_t end = session.received.find('\n', session.consumed);
+        if (end != std::string::npos)
+        {
+            line.assign(session.received, session.consumed, end - session.consumed);
+            session.consumed = end + 1;
+            return true;
+        }
+
+        if (session.consumed > 0)
+        {
+            session.received.erase(0, session.consumed);
+            session.consumed = 0;
+        }
+
+        if (session.closed)
+        {
+            //the last line may come without a newline
+            if (session.received.empty())
+                return false;
+
+            line.swap(session.received);
+            session.received.clear();
+            return true;
+        }
+
+        std::size_t seen = session.events.load();
+        char buffer[4096];
+        ssize_t got = recv(session.fd, buffer, sizeof(buffer), 0);
+
+        if (got > 0)
+        {
+            session.received.append(buffer, got);
+            if (session.received.size() > SESSION_LINE_LIMIT && session.received.find('\n') == std::string::npos)
+                throw std::invalid_argument("input line too long");
+        }
+        else if (got == 0)
+            session.closed = true;
+        else if (errno == EAGAIN || errno == EWOULDBLOCK)
+        {
+            SessionOutput(session).flush();
+            TaskScheduler::park(session.events, seen);
+        }
+        else if (errno != EINTR)
+            session.closed = true;
+    }
+}
+
+inline SessionOutput::SessionOutput(Session &_session) : session(_session)
+{
+}
+
+inline void SessionOutput::write_value(value_t value)
+{
+    write_text(value_to_string(value) + "\n");
+}
+
+inline void SessionOutput::write_text(const std::string &text)
+{
+    if (session.broken)
+        return;
+
+    session.outgoing += text;
+    if (session.outgoing.size() >= 64 * 1024)
+        flush();
+}
+
+//a full socket buffer parks the task like an empty one does in READ
+inline void SessionOutput::flush()
+{
+    std::size_t sent = 0;
+
+    while (sent < session.outgoing.size() && !session.broken)
+    {
+        std::size_t seen = session.events.load();
+        ssize_t put = send(session.fd, session.outgoing.data() + sent, session.outgoing.size() - sent, MSG_NOSIGNAL);
+
+        if (put >= 0)
+            sent += put;
+        else if (errno == EAGAIN || errno == EWOULDBLOCK)
+            TaskScheduler::park(session.events, seen);
+        else if (errno != EINTR)
+            session.broken = true;
+    }
+
+    session.outgoing.clear();
+}
+
+inline SessionServer::SessionServer(const CompiledProgram &_program, int port)
+    : program(_program), listener(-1), epoll(-1), stopper(-1), bound_port(0), stopping(false),
+      scheduler(ThreadPool::default_size())
+{
+    try
+    {
+        listener = socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+        if (listener < 0)
+            throw std::system_error(errno, std::generic_category(), "socket");
+
+        int reuse = 1;
+        setsockopt(listener, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+
+        sockaddr_in address{};
+        address.sin_family = AF_INET;
+        address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        address.sin_port = htons(port);
+
+        if (bind(listener, (sockaddr *)&address, sizeof(address)) < 0)
+            throw std::system_error(errno, std::generic_category(), "bind");
+        if (listen(listener, SOMAXCONN) < 0)
+            throw std::system_error(errno, std::generic_category(), "listen");
+
+        socklen_t length = sizeof(address);
+        getsockname(listener, (sockaddr *)&address, &length);
+        bound_port = ntohs(address.sin_port);
+
+        epoll = epoll_create1(EPOLL_CLOEXEC);
+        stopper = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+        if (epoll < 0 || stopper < 0)
+            throw std::system_error(errno, std::generic_category(), "epoll");
+
+        //the listener and the eventfd are told apart from the sessions by their data pointers
+        epoll_event event{};
+        event.events = EPOLLIN;
+        event.data.ptr = &listener;
+        epoll_ctl(epoll, EPOLL_CTL_ADD, listener, &event);
+
+        event.data.ptr = &stopper;
+        epoll_ctl(epoll, EPOLL_CTL_ADD, stopper, &event);
+    }
+    catch (...)
+    {
+        if (listener >= 0)
+            close(listener);
+        if (epoll >= 0)
+            close(epoll);
+        if (stopper >= 0)
+            close(stopper);
+        throw;
+    }
+}
+
+//sessions that are still running are dropped with the scheduler
+inline SessionServer::~SessionServer()
+{
+    for (std::unordered_map<int, std::unique_ptr<Session>>::iterator it = open.begin(); it != open.end(); ++it)
+        close(it->first);
+
+    close(listener);
+    close(epoll);
+    close(stopper);
+}
+
+inline int SessionServer::port() const
+{
+    return bound_port;
+}
+
+inline void SessionServer::stop()
+{
+    uint64_t one = 1;
+    if (write(stopper, &one, sizeof(one)) < 0)
+        throw std::system_error(errno, std::generic_category(), "eventfd");
+}
+
+inline void SessionServer::accept_all()
+{
+    while (true)
+    {
+        int fd = accept4(listener, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+        if (fd < 0)
+        {
+            if (errno == EINTR || errno == ECONNABORTED)
+                continue;
+            return; //EAGAIN, or out of descriptors until some session closes
+        }
+
+        Session *session = new Session(fd);
+        open[fd].reset(session);
+
+        //edge triggered: the loop only has to count the edges, the task reads and writes until EAGAIN
+        epoll_event event{};
+        event.events = EPOLLIN | EPOLLOUT | EPOLLRDHUP | EPOLLET;
+        event.data.ptr = session;
+        epoll_ctl(epoll, EPOLL_CTL_ADD, fd, &event);
+
+        start(session);
+    }
+}
+
+//every session gets a fresh interpreter, a failing program reports to its own client only
+inline void SessionServer::start(Session *session)
+{
+    const CompiledProgram *compiled = &program;
+
+    scheduler.spawn([session, compiled]() {
+        SessionInput input(*session);
+        SessionOutput output(*session);
+
+        try
+        {
+            std::unique_ptr<Interpreter> interpreter(new Interpreter());
+            interpreter->execute(compiled->root(), compiled->labels(), input, output, &compiled->loops().loops);
+        }
+        catch (const std::exception &e)
+        {
+            output.write_text(std::string("runtime error: ") + e.what() + "\n");
+        }
+
+        output.flush();
+        session->finished = true;
+    });
+}
+
+inline void SessionServer::close_finished()
+{
+    for (std::unordered_map<int, std::unique_ptr<Session>>::iterator it = open.begin(); it != open.end();)
+    {
+        if (it->second->finished)
+        {
+            close(it->first);
+            it = open.erase(it);
+        }
+        else
+            ++it;
+    }
+}
+
+//the tasks only run between the waits, so a task never sees the loop change its session
+//except through the events counter. the loop polls without blocking while tasks are still moving
+inline void SessionServer::run()
+{
+    epoll_event events[256];
+    bool busy = false;
+
+    while (!stopping)
+    {
+        int count = epoll_wait(epoll, events, 256, busy ? 0 : -1);
+        if (count < 0)
+        {
+            if (errno == EINTR)
+                continue;
+            throw std::system_error(errno, std::generic_category(), "epoll_wait");
+        }
+
+        for (int i = 0; i < count; ++i)
+        {
+            if (events[i].data.ptr == &listener)
+                accept_all();
+            else if (events[i].data.ptr == &stopper)
+                stopping = true;
+            else
+                ((Session *)events[i].data.ptr)->events.fetch_add(1);
+        }
+
+        busy = scheduler.run_round();
+        close_finished();
+    }
+}
+
+#endif
\ No newline at end of file
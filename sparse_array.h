@@ -0,0 +1,55 @@
+#pragma once
+
+#ifndef SPARSE_ARRAY_HEADER
+#define SPARSE_ARRAY_HEADER
+
+#include <algorithm>
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+////SPARSE ARRAYS////
+//the elements of LET a[n] SPARSE: an open addressing hash table from positions to values that holds
+//only the elements that are not 0, so memory follows the number of entries instead of the declared size.
+//keys and values sit next to each other in one block and collisions probe the following slots,
+//so a lookup usually touches a single cache line. the table is kept at most half full and
+//erasing shifts the following entries back instead of leaving tombstones
+class SparseArray
+{
+public:
+    SparseArray();
+
+    //0 for positions that were never set
+    value_t get(long long position) const;
+    //storing 0 removes the entry
+    void set(long long position, const value_t &v);
+
+    //the number of entries, elements that are not 0
+    std::size_t size() const;
+    //calls f(position, value) for every entry, in no particular order
+    template <class F>
+    void for_each(F f) const;
+    //the entries sorted by position
+    std::vector<std::pair<long long, value_t>> entries() const;
+
+    void clear();
+
+private:
+    struct Slot
+    {
+        long long position; //EMPTY for free slots
+        value_t value;
+    };
+    static const long long EMPTY = -1;
+
+    std::vector<Slot> slots; //a power of two long, empty until the first entry
+    std::size_t count;
+    int shift; //64 minus log2 of the slot count
+
+    std::size_t home(long long position) const;
+    void grow();
+};
+
+#include "sparse_array.inl"
+
+#endif
\ No newline at end of file
@@ -0,0 +1,132 @@
+#ifndef SPARSE_ARRAY_SOURCE
+#define SPARSE_ARRAY_SOURCE
+
+inline SparseArray::SparseArray() : count(0), shift(64) {}
+
+//fibonacci hashing, the top bits of the product spread neighbouring positions over the table
+inline std::size_t SparseArray::home(long long position) const
+{
+    return (std::size_t)(((unsigned long long)position * 0x9E3779B97F4A7C15ull) >> shift);
+}
+
+inline value_t SparseArray::get(long long position) const
+{
+    if (count == 0)
+        return 0;
+
+    std::size_t mask = slots.size() - 1;
+    for (std::size_t i = home(position);; i = (i + 1) & mask)
+    {
+        if (slots[i].position == position)
+            return slots[i].value;
+        if (slots[i].position == EMPTY)
+            return 0;
+    }
+}
+
+inline void SparseArray::set(long long position, const value_t &v)
+{
+    if (!v)
+    {
+        if (count == 0)
+            return;
+
+        std::size_t mask = slots.size() - 1;
+        std::size_t hole = home(position);
+        while (slots[hole].position != position)
+        {
+            if (slots[hole].position == EMPTY)
+                return;
+            hole = (hole + 1) & mask;
+        }
+
+        //an entry further along the run moves into the hole unless its home lies between the two
+        for (std::size_t i = (hole + 1) & mask; slots[i].position != EMPTY; i = (i + 1) & mask)
+        {
+            std::size_t wanted = home(slots[i].position);
+            if (((i - wanted) & mask) >= ((i - hole) & mask))
+            {
+                slots[hole] = std::move(slots[i]);
+                hole = i;
+            }
+        }
+
+        slots[hole].position = EMPTY;
+        slots[hole].value = 0;
+        --count;
+        return;
+    }
+
+    if ((count + 1) * 2 > slots.size())
+        grow();
+
+    std::size_t mask = slots.size() - 1;
+    std::size_t i = home(position);
+    while (slots[i].position != EMPTY && slots[i].position != position)
+        i = (i + 1) & mask;
+
+    if (slots[i].position == EMPTY)
+    {
+        slots[i].position = position;
+        ++count;
+    }
+    slots[i].value = v;
+}
+
+inline void SparseArray::grow()
+{
+    std::vector<Slot> old;
+    old.swap(slots);
+
+    std::size_t size = old.empty() ? 16 : old.size() * 2;
+    slots.resize(size, Slot{EMPTY, 0});
+    shift = 64;
+    for (std::size_t s = size; s > 1; s >>= 1)
+        --shift;
+
+    std::size_t mask = size - 1;
+    for (std::size_t k = 0; k < old.size(); ++k)
+    {
+        if (old[k].position == EMPTY)
+            continue;
+
+        std::size_t i = home(old[k].position);
+        while (slots[i].position != EMPTY)
+            i = (i + 1) & mask;
+        slots[i] = std::move(old[k]);
+    }
+}
+
+inline std::size_t SparseArray::size() const
+{
+    return count;
+}
+
+template <class F>
+inline void SparseArray::for_each(F f) const
+{
+    for (std::size_t i = 0; i < slots.size(); ++i)
+        if (slots[i].position != EMPTY)
+            f(slots[i].position, slots[i].value);
+}
+
+inline std::vector<std::pair<long long, value_t>> SparseArray::entries() const
+{
+    std::vector<std::pair<long long, value_t>> result;
+    result.reserve(count);
+    for_each([&result](long long position, const value_t &v) { result.emplace_back(position, v); });
+
+    std::sort(result.begin(), result.end(), [](const std::pair<long long, value_t> &a, const std::pair<long long, value_t> &b) {
+        return a.first < b.first;
+    });
+    return result;
+}
+
+inline void SparseArray::clear()
+{
+    slots.clear();
+    count = 0;
+    shift = 64;
+}
+
+#endif
\ No newline at end of file
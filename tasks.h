@@ -0,0 +1,142 @@
+#pragma once
+
+#ifndef TASKS_HEADER
+#define TASKS_HEADER
+
+#include <atomic>
+#include <cstdint>
+#include <condition_variable>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <new>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+#include <sys/mman.h>
+#include <ucontext.h>
+
+////GREEN THREADS////
+//the scheduler behind SPAWN, JOIN and YIELD. every task runs on its own small stack and gives the
+//thread back only when it yields or finishes, so a task costs its context plus the stack pages it touched.
+//the tasks are spread round robin over a few threads and stay on the thread they were given;
+//thread 0 is the caller's own thread, so with one thread everything runs in spawn order.
+//a task blocked on a channel parks on one of its counters and is skipped until the counter moves
+
+//virtual size of a task stack, as large as a thread's so a task runs what the program itself can run.
+//the slabs are mapped without reserving swap and only the pages a task really touches take memory
+static const std::size_t TASK_STACK_SIZE = 8 * 1024 * 1024;
+//stacks are carved from larger mappings, one mapping per stack would run into the kernel's map count limit
+static const std::size_t TASK_STACKS_PER_SLAB = 64;
+//the lowest page of a stack is a PROT_NONE guard, so an overflow faults instead of writing into the stack below.
+//a guard splits the slab's mapping in two, so only this many stacks in the process get one and the kernel's
+//default limit of 65530 maps is never used up; the stacks after them rely on the parser's nesting limit
+static const std::size_t TASK_GUARD_SIZE = 4096;
+static const std::size_t TASK_GUARDED_STACKS = 16384;
+
+class TaskScheduler
+{
+public:
+    explicit TaskScheduler(std::size_t threads);
+    //tasks that never finished are cancelled: they are resumed once more and their YIELD or park throws,
+    //so their stacks unwind and free what the task holds
+    ~TaskScheduler();
+
+    TaskScheduler(const TaskScheduler &) = delete;
+    TaskScheduler &operator=(const TaskScheduler &) = delete;
+
+    //the task starts at the next run_round or run_all
+    void spawn(std::function<void()> body);
+
+    //resumes every unfinished task that isn't parked once, until it yields or finishes,
+    //and returns false when there was no such task
+    bool run_round();
+    //resumes the tasks until all of them finished, throws when the tasks left are all parked for good
+    void run_all();
+
+    //both rethrow the error of the first task, in spawn order, that failed during the run
+
+    //called by a running task to give its thread to the next one, does nothing outside tasks
+    static void yield();
+    static bool inside_task();
+
+    //yields until counter is no longer seen; the task must call notify after every change it makes
+    //to a counter others may park on, so threads with only parked tasks wake up
+    static void park(const std::atomic<std::size_t> &counter, std::size_t seen);
+    static void notify();
+
+private:
+    struct Task
+    {
+        ucontext_t context;
+        ucontext_t *caller; //the scheduler loop that resumed the task last
+        std::function<void()> body;
+        char *stack;
+        std::size_t id;
+        bool finished;
+        bool cancelled;
+        std::exception_ptr error;
+
+        TaskScheduler *owner;
+        const std::atomic<std::size_t> *park_on; //null while the task isn't parked
+        std::size_t park_seen;
+
+        bool parked() const;
+    };
+
+    std::vector<std::vector<Task *>> owned; //the tasks of every thread
+    std::size_t spawned;
+
+    std::vector<char *> slabs;
+    std::vector<char *> free_stacks;
+    std::size_t guarded_slabs;
+    //guarded stacks of all schedulers together
+    static std::atomic<std::size_t> &guarded_stacks();
+
+    //threads 1.. wait here for the next run, thread 0 is the caller
+    std::vector<std::thread> threads;
+    std::mutex lock;
+    std::condition_variable wake, done;
+    std::size_t generation;
+    std::size_t running;
+    bool until_finished;
+    bool stopping;
+    bool progress; //some task ran during the last run
+
+    //a run_all thread whose tasks are all parked sleeps on park_wake until a task elsewhere notifies.
+    //a notify wakes every sleeper, so when the sleepers and the threads without tasks left are
+    //all the threads, nothing can move anymore
+    std::mutex park_lock;
+    std::condition_variable park_wake;
+    std::atomic<std::size_t> waiting;
+    std::size_t changes;
+    std::size_t sleeping;
+    std::size_t finished_threads;
+    bool deadlocked;
+
+    bool run(bool all);
+    //returns whether any task ran
+    bool run_owned(std::size_t thread, bool all);
+    //returns false when no thread can move anymore
+    bool wait_for_change(std::size_t thread);
+    void thread_done();
+    void thread_loop(std::size_t thread);
+    //frees the finished tasks and rethrows the first error
+    void collect();
+    //unwinds and frees every task that didn't finish
+    void cancel();
+    //thrown out of yield and park in a cancelled task, it is no std::exception so the program can't catch it
+    struct Cancelled
+    {
+    };
+    static void resumed(Task *task);
+    char *take_stack();
+
+    static void entry(unsigned high, unsigned low);
+    static Task *&current();
+};
+
+#include "tasks.inl"
+
+#endif
\ No newline at end of file
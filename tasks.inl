@@ -0,0 +1,407 @@
+#ifndef TASKS_SOURCE
+#define TASKS_SOURCE
+
+inline TaskScheduler::TaskScheduler(std::size_t threads)
+    : owned(threads ? threads : 1), spawned(0), guarded_slabs(0), generation(0), running(0), until_finished(false), stopping(false),
+      progress(false), waiting(0), changes(0), sleeping(0), finished_threads(0), deadlocked(false)
+{
+}
+
+inline TaskScheduler::~TaskScheduler()
+{
+    cancel();
+
+    {
+        std::lock_guard<std::mutex> guard(lock);
+        stopping = true;
+    }
+    wake.notify_all();
+
+    for (std::size_t i = 0; i < threads.size(); ++i)
+        threads[i].join();
+
+    for (std::size_t t = 0; t < owned.size(); ++t)
+        for (std::size_t i = 0; i < owned[t].size(); ++i)
+            delete owned[t][i];
+
+    for (std::size_t i = 0; i < slabs.size(); ++i)
+        munmap(slabs[i], TASK_STACK_SIZE * TASK_STACKS_PER_SLAB);
+    guarded_stacks() -= guarded_slabs * TASK_STACKS_PER_SLAB;
+}
+
+inline std::atomic<std::size_t> &TaskScheduler::guarded_stacks()
+{
+    static std::atomic<std::size_t> count(0);
+    return count;
+}
+
+inline TaskScheduler::Task *&TaskScheduler::current()
+{
+    static thread_local Task *task = nullptr;
+    return task;
+}
+
+inline bool TaskScheduler::inside_task()
+{
+    return current() != nullptr;
+}
+
+inline bool TaskScheduler::Task::parked() const
+{
+    return !cancelled && park_on && park_on->load() == park_seen;
+}
+
+inline char *TaskScheduler::take_stack()
+{
+    if (free_stacks.empty())
+    {
+        void *slab = mmap(nullptr, TASK_STACK_SIZE * TASK_STACKS_PER_SLAB, PROT_READ | PROT_WRITE,
+                          MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE | MAP_STACK, -1, 0);
+        if (slab == MAP_FAILED)
+            throw std::bad_alloc();
+
+        slabs.push_back((char *)slab);
+        for (std::size_t i = TASK_STACKS_PER_SLAB; i > 0; --i)
+            free_stacks.push_back((char *)slab + (i - 1) * TASK_STACK_SIZE);
+
+        if (guarded_stacks().fetch_add(TASK_STACKS_PER_SLAB) + TASK_STACKS_PER_SLAB <= TASK_GUARDED_STACKS)
+        {
+            ++guarded_slabs;
+            for (std::size_t i = 0; i < TASK_STACKS_PER_SLAB; ++i)
+                mprotect((char *)slab + i * TASK_STACK_SIZE, TASK_GUARD_SIZE, PROT_NONE);
+        }
+        else
+            guarded_stacks() -= TASK_STACKS_PER_SLAB;
+    }
+
+    char *stack = free_stacks.back();
+    free_stacks.pop_back();
+    return stack;
+}
+
+//makecontext only passes ints, so the task pointer comes in two halves
+inline void TaskScheduler::entry(unsigned high, unsigned low)
+{
+    Task *task = (Task *)(((std::uintptr_t)high << 32) | (std::uintptr_t)low);
+
+    try
+    {
+        task->body();
+    }
+    catch (...)
+    {
+        task->error = std::current_exception();
+    }
+
+    task->finished = true;
+    swapcontext(&task->context, task->caller);
+}
+
+inline void TaskScheduler::spawn(std::function<void()> body)
+{
+    Task *task = new Task();
+    task->body = std::move(body);
+    task->id = spawned;
+    task->finished = false;
+    task->cancelled = false;
+    task->caller = nullptr;
+    task->owner = this;
+    task->park_on = nullptr;
+    task->park_seen = 0;
+
+    try
+    {
+        task->stack = take_stack();
+    }
+    catch (...)
+    {
+        delete task;
+        throw;
+    }
+
+    getcontext(&task->context);
+    task->context.uc_stack.ss_sp = task->stack + TASK_GUARD_SIZE;
+    task->context.uc_stack.ss_size = TASK_STACK_SIZE - TASK_GUARD_SIZE;
+    task->context.uc_link = nullptr;
+
+    std::uintptr_t address = (std::uintptr_t)task;
+    makecontext(&task->context, (void (*)())&TaskScheduler::entry, 2, (unsigned)(address >> 32), (unsigned)address);
+
+    owned[spawned % owned.size()].push_back(task);
+    ++spawned;
+}
+
+//a task that is cancelled doesn't switch anymore; it throws, or returns while it is already unwinding
+inline void TaskScheduler::resumed(Task *task)
+{
+    if (task->cancelled && std::uncaught_exceptions() == 0)
+        throw Cancelled();
+}
+
+inline void TaskScheduler::yield()
+{
+    Task *task = current();
+    if (!task)
+        return;
+
+    if (!task->cancelled)
+        swapcontext(&task->context, task->caller);
+    resumed(task);
+}
+
+inline void TaskScheduler::park(const std::atomic<std::size_t> &counter, std::size_t seen)
+{
+    Task *task = current();
+    if (!task)
+        return;
+
+    if (!task->cancelled)
+    {
+        task->park_on = &counter;
+        task->park_seen = seen;
+        swapcontext(&task->context, task->caller);
+    }
+    resumed(task);
+}
+
+//the counter was changed before waiting is read, and a sleeping thread raises waiting before it
+//rechecks its counters, so either the thread sees the change or the change sees the thread
+inline void TaskScheduler::notify()
+{
+    Task *task = current();
+    if (!task || task->owner->waiting.load() == 0)
+        return;
+
+    TaskScheduler *owner = task->owner;
+    {
+        std::lock_guard<std::mutex> guard(owner->park_lock);
+        ++owner->changes;
+        owner->sleeping = 0;
+    }
+    owner->park_wake.notify_all();
+}
+
+inline bool TaskScheduler::run_owned(std::size_t thread, bool all)
+{
+    std::vector<Task *> &tasks = owned[thread];
+    ucontext_t here;
+    bool ran = false;
+
+    bool active = true;
+    while (active)
+    {
+        active = false;
+        bool moved = false;
+        for (std::size_t i = 0; i < tasks.size(); ++i)
+        {
+            Task *task = tasks[i];
+            if (task->finished)
+                continue;
+
+            if (task->parked())
+            {
+                active = true;
+                continue;
+            }
+
+            task->park_on = nullptr;
+            task->caller = &here;
+            current() = task;
+            swapcontext(&here, &task->context);
+            current() = nullptr;
+
+            moved = true;
+            active |= !task->finished;
+        }
+
+        ran |= moved;
+        if (!all)
+            break;
+
+        if (active && !moved && !wait_for_change(thread))
+            return ran;
+    }
+
+    if (all)
+        thread_done();
+    return ran;
+}
+
+inline bool TaskScheduler::wait_for_change(std::size_t thread)
+{
+    std::unique_lock<std::mutex> guard(park_lock);
+    ++waiting;
+
+    std::vector<Task *> &tasks = owned[thread];
+    for (std::size_t i = 0; i < tasks.size(); ++i)
+        if (!tasks[i]->finished && !tasks[i]->parked())
+        {
+            --waiting;
+            return true;
+        }
+
+    ++sleeping;
+    std::size_t seen = changes;
+    if (sleeping + finished_threads >= owned.size())
+    {
+        deadlocked = true;
+        park_wake.notify_all();
+    }
+    else
+        park_wake.wait(guard, [this, seen]() { return changes != seen || deadlocked; });
+
+    --waiting;
+    return !deadlocked;
+}
+
+inline void TaskScheduler::thread_done()
+{
+    std::lock_guard<std::mutex> guard(park_lock);
+    ++finished_threads;
+    if (sleeping && sleeping + finished_threads >= owned.size())
+    {
+        deadlocked = true;
+        park_wake.notify_all();
+    }
+}
+
+inline void TaskScheduler::thread_loop(std::size_t thread)
+{
+    std::size_t seen = 0;
+
+    while (true)
+    {
+        bool all;
+        {
+            std::unique_lock<std::mutex> guard(lock);
+            wake.wait(guard, [this, seen]() { return stopping || generation != seen; });
+            if (stopping)
+                return;
+
+            seen = generation;
+            all = until_finished;
+        }
+
+        bool ran = run_owned(thread, all);
+
+        std::lock_guard<std::mutex> guard(lock);
+        progress |= ran;
+        if (--running == 0)
+            done.notify_one();
+    }
+}
+
+inline bool TaskScheduler::run(bool all)
+{
+    {
+        std::lock_guard<std::mutex> guard(park_lock);
+        sleeping = 0;
+        finished_threads = 0;
+        deadlocked = false;
+    }
+
+    bool ran;
+    if (owned.size() > 1)
+    {
+        for (std::size_t t = threads.size() + 1; t < owned.size(); ++t)
+            threads.push_back(std::thread(&TaskScheduler::thread_loop, this, t));
+
+        {
+            std::lock_guard<std::mutex> guard(lock);
+            until_finished = all;
+            running = owned.size() - 1;
+            progress = false;
+            ++generation;
+        }
+        wake.notify_all();
+
+        ran = run_owned(0, all);
+
+        std::unique_lock<std::mutex> guard(lock);
+        done.wait(guard, [this]() { return running == 0; });
+        ran |= progress;
+    }
+    else
+        ran = run_owned(0, all);
+
+    collect();
+
+    if (deadlocked)
+        throw std::invalid_argument("every task is waiting on a channel");
+    return ran;
+}
+
+inline bool TaskScheduler::run_round()
+{
+    return run(false);
+}
+
+inline void TaskScheduler::run_all()
+{
+    run(true);
+}
+
+inline void TaskScheduler::collect()
+{
+    std::exception_ptr error;
+    std::size_t error_id = spawned;
+
+    for (std::size_t t = 0; t < owned.size(); ++t)
+    {
+        std::vector<Task *> &tasks = owned[t];
+        std::size_t kept = 0;
+
+        for (std::size_t i = 0; i < tasks.size(); ++i)
+        {
+            Task *task = tasks[i];
+            if (!task->finished)
+            {
+                tasks[kept++] = task;
+                continue;
+            }
+
+            if (task->error && task->id < error_id)
+            {
+                error = task->error;
+                error_id = task->id;
+            }
+
+            free_stacks.push_back(task->stack);
+            delete task;
+        }
+
+        tasks.resize(kept);
+    }
+
+    if (error)
+        std::rethrow_exception(error);
+}
+
+//tasks that never ran just have to be freed; the others run on their own threads once more,
+//every YIELD or park throws there, and the stack unwinds up to entry
+inline void TaskScheduler::cancel()
+{
+    bool started = false;
+    for (std::size_t t = 0; t < owned.size(); ++t)
+        for (std::size_t i = 0; i < owned[t].size(); ++i)
+        {
+            Task *task = owned[t][i];
+            task->cancelled = true;
+            if (!task->caller)
+                task->finished = true;
+            started |= !task->finished;
+        }
+
+    try
+    {
+        if (started)
+            run(true);
+        else
+            collect();
+    }
+    catch (...)
+    {
+    }
+}
+
+#endif
\ No newline at end of file
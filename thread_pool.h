@@ -0,0 +1,74 @@
+#pragma once
+
+#ifndef THREAD_POOL_HEADER
+#define THREAD_POOL_HEADER
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdlib>
+#include <deque>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+////THREAD POOL////
+//every worker owns a deque: it pops its own work from the back and steals from the front of the others.
+//tasks submitted from inside a worker go to that worker's deque, the rest are spread round robin.
+class ThreadPool
+{
+public:
+    explicit ThreadPool(std::size_t threads = std::thread::hardware_concurrency());
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool &) = delete;
+    ThreadPool &operator=(const ThreadPool &) = delete;
+
+    template <class F>
+    std::future<std::invoke_result_t<F>> submit(F task);
+
+    //runs one queued task on the calling thread, used by callers that wait on their own subtasks
+    bool run_pending_task();
+
+    //blocks until the future is ready while helping with queued work, so nested waits can't deadlock the pool
+    template <class T>
+    T wait(std::future<T> &result);
+
+    std::size_t size() const;
+
+    //process wide pool with default_size() workers, created on first use by the built-ins that run in parallel
+    static ThreadPool &shared();
+
+    //one thread per core, or as many as the BASIC_THREADS environment variable says
+    static std::size_t default_size();
+
+private:
+    struct WorkQueue
+    {
+        std::mutex lock;
+        std::deque<std::function<void()>> tasks;
+    };
+
+    std::vector<std::unique_ptr<WorkQueue>> queues;
+    std::vector<std::thread> workers;
+
+    std::mutex sleep_lock;
+    std::condition_variable wake;
+    std::atomic<std::size_t> pending;
+    std::atomic<std::size_t> next_queue;
+    bool stopping;
+
+    void push(std::function<void()> task);
+    bool pop_task(std::size_t home, std::function<void()> &task);
+    void worker_loop(std::size_t index);
+
+    static ThreadPool *&current_pool();
+    static std::size_t &current_index();
+};
+
+#include "thread_pool.inl"
+
+#endif
\ No newline at end of file
@@ -0,0 +1,168 @@
+#ifndef THREAD_POOL_SOURCE
+#define THREAD_POOL_SOURCE
+
+inline ThreadPool::ThreadPool(std::size_t threads) : pending(0), next_queue(0), stopping(false)
+{
+    if (threads == 0)
+        threads = 1;
+
+    for (std::size_t i = 0; i < threads; ++i)
+        queues.push_back(std::unique_ptr<WorkQueue>(new WorkQueue()));
+
+    for (std::size_t i = 0; i < threads; ++i)
+        workers.push_back(std::thread(&ThreadPool::worker_loop, this, i));
+}
+
+inline ThreadPool::~ThreadPool()
+{
+    {
+        std::lock_guard<std::mutex> guard(sleep_lock);
+        stopping = true;
+    }
+    wake.notify_all();
+
+    for (std::size_t i = 0; i < workers.size(); ++i)
+        workers[i].join();
+}
+
+inline ThreadPool *&ThreadPool::current_pool()
+{
+    static thread_local ThreadPool *pool = nullptr;
+    return pool;
+}
+
+inline std::size_t &ThreadPool::current_index()
+{
+    static thread_local std::size_t index = 0;
+    return index;
+}
+
+inline ThreadPool &ThreadPool::shared()
+{
+    static ThreadPool pool(default_size());
+    return pool;
+}
+
+inline std::size_t ThreadPool::default_size()
+{
+    const char *threads = std::getenv("BASIC_THREADS");
+    long count = threads ? std::atol(threads) : 0;
+    return count > 0 ? (std::size_t)count : (std::size_t)std::thread::hardware_concurrency();
+}
+
+inline std::size_t ThreadPool::size() const
+{
+    return workers.size();
+}
+
+template <class F>
+inline std::future<std::invoke_result_t<F>> ThreadPool::submit(F task)
+{
+    typedef std::invoke_result_t<F> result_type;
+
+    //std::function needs a copyable target, so the packaged task is shared
+    std::shared_ptr<std::packaged_task<result_type()>> job(new std::packaged_task<result_type()>(task));
+    std::future<result_type> result = job->get_future();
+
+    push([job]() { (*job)(); });
+
+    return result;
+}
+
+inline void ThreadPool::push(std::function<void()> task)
+{
+    std::size_t target;
+    if (current_pool() == this)
+        target = current_index();
+    else
+        target = next_queue.fetch_add(1) % queues.size();
+
+    {
+        std::lock_guard<std::mutex> guard(queues[target]->lock);
+        queues[target]->tasks.push_back(std::move(task));
+    }
+
+    {
+        std::lock_guard<std::mutex> guard(sleep_lock);
+        ++pending;
+    }
+    wake.notify_one();
+}
+
+inline bool ThreadPool::pop_task(std::size_t home, std::function<void()> &task)
+{
+    {
+        std::lock_guard<std::mutex> guard(queues[home]->lock);
+        if (!queues[home]->tasks.empty())
+        {
+            task = std::move(queues[home]->tasks.back());
+            queues[home]->tasks.pop_back();
+            --pending;
+            return true;
+        }
+    }
+
+    for (std::size_t i = 1; i < queues.size(); ++i)
+    {
+        WorkQueue &victim = *queues[(home + i) % queues.size()];
+
+        std::lock_guard<std::mutex> guard(victim.lock);
+        if (!victim.tasks.empty())
+        {
+            task = std::move(victim.tasks.front());
+            victim.tasks.pop_front();
+            --pending;
+            return true;
+        }
+    }
+
+    return false;
+}
+
+inline bool ThreadPool::run_pending_task()
+{
+    std::size_t home = current_pool() == this ? current_index() : 0;
+
+    std::function<void()> task;
+    if (!pop_task(home, task))
+        return false;
+
+    task();
+    return true;
+}
+
+template <class T>
+inline T ThreadPool::wait(std::future<T> &result)
+{
+    while (result.wait_for(std::chrono::seconds(0)) != std::future_status::ready)
+    {
+        if (!run_pending_task())
+            std::this_thread::yield();
+    }
+
+    return result.get();
+}
+
+inline void ThreadPool::worker_loop(std::size_t index)
+{
+    current_pool() = this;
+    current_index() = index;
+
+    while (true)
+    {
+        std::function<void()> task;
+        if (pop_task(index, task))
+        {
+            task();
+            continue;
+        }
+
+        std::unique_lock<std::mutex> guard(sleep_lock);
+        wake.wait(guard, [this]() { return stopping || pending > 0; });
+
+        if (stopping && pending == 0)
+            return;
+    }
+}
+
+#endif
\ No newline at end of file
@@ -0,0 +1,104 @@
+#pragma once
+
+#ifndef TRACER_HEADER
+#define TRACER_HEADER
+
+#include <atomic>
+#include <chrono>
+#include <fstream>
+#include <thread>
+
+#include "program.h"
+
+//fixed size so the ring buffer never allocates; names point to string literals
+struct TraceEvent
+{
+    char phase; //'B'/'E' begin and end, 'X' complete, 'i' instant
+    const char *name;
+    double ts_us;
+    double dur_us;
+    int line;
+    long long count;
+    char label[40];
+};
+
+////TRACE RING////
+//single producer (the interpreter thread) / single consumer (the flusher thread), lock free.
+//a full ring drops the event instead of making the interpreter wait.
+class TraceRing
+{
+public:
+    TraceRing(std::size_t capacity_power_of_two);
+
+    bool push(const TraceEvent &event);
+    bool pop(TraceEvent &event);
+
+    long long dropped() const;
+
+private:
+    std::vector<TraceEvent> events;
+    std::size_t mask;
+
+    alignas(64) std::atomic<std::size_t> head; //next slot to write, only the producer moves it
+    alignas(64) std::atomic<std::size_t> tail; //next slot to read, only the consumer moves it
+    std::atomic<long long> lost;
+};
+
+////TRACER////
+//writes Chrome trace-event JSON (chrome://tracing, Perfetto); a background thread drains the ring to disk
+class Tracer
+{
+public:
+    Tracer(const std::string &filename, std::size_t capacity_power_of_two = 1 << 16);
+    ~Tracer();
+
+    void phase_begin(const char *name);
+    void phase_end(const char *name);
+    void complete(const char *name, double start_us, int line, long long count, const std::string &label = "");
+    void instant(const char *name, int line, const std::string &label);
+
+    double now_us() const;
+
+    //stops the flusher and writes everything that is still buffered
+    void close();
+
+private:
+    TraceRing ring;
+    std::ofstream file;
+    std::chrono::steady_clock::time_point origin;
+
+    std::atomic<bool> running;
+    std::thread flusher;
+    bool first_event;
+
+    void emit(char phase, const char *name, double ts_us, double dur_us, int line, long long count, const std::string &label);
+    void drain();
+    void write_event(const TraceEvent &event);
+};
+
+////TRACING INTERPRETER////
+//traces every outermost WHILE loop with its iteration count, every GOTO and the time spent waiting in READ
+class TracingInterpreter : public Interpreter
+{
+private:
+    Tracer &tracer;
+
+    int loop_depth;
+    AST_Node *traced_body; //body of the outermost loop that is running
+    long long iterations;
+
+public:
+    TracingInterpreter(Tracer &_tracer);
+
+    using Interpreter::visit;
+
+    void visit(BlockCode *ast);
+    void visit(While *ast);
+    void visit(GoTo *ast);
+    void visit(ReadVar *ast);
+    void visit(ReadArr *ast);
+};
+
+#include "tracer.inl"
+
+#endif
\ No newline at end of file
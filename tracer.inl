@@ -0,0 +1,229 @@
+#ifndef TRACER_SOURCE
+#define TRACER_SOURCE
+
+#include <cstring>
+#include <iomanip>
+
+//TRACE RING
+
+inline TraceRing::TraceRing(std::size_t capacity_power_of_two)
+    : events(capacity_power_of_two), mask(capacity_power_of_two - 1), head(0), tail(0), lost(0)
+{
+    if (capacity_power_of_two == 0 || (capacity_power_of_two & mask))
+        throw std::invalid_argument("trace buffer size must be a power of two");
+}
+
+inline bool TraceRing::push(const TraceEvent &event)
+{
+    std::size_t write = head.load(std::memory_order_relaxed);
+    if (write - tail.load(std::memory_order_acquire) == events.size())
+    {
+        lost.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+
+    events[write & mask] = event;
+    head.store(write + 1, std::memory_order_release);
+
+    return true;
+}
+
+inline bool TraceRing::pop(TraceEvent &event)
+{
+    std::size_t read = tail.load(std::memory_order_relaxed);
+    if (read == head.load(std::memory_order_acquire))
+        return false;
+
+    event = events[read & mask];
+    tail.store(read + 1, std::memory_order_release);
+
+    return true;
+}
+
+inline long long TraceRing::dropped() const
+{
+    return lost.load(std::memory_order_relaxed);
+}
+
+//TRACER
+
+inline Tracer::Tracer(const std::string &filename, std::size_t capacity_power_of_two)
+    : ring(capacity_power_of_two), file(filename), origin(std::chrono::steady_clock::now()), running(true), first_event(true)
+{
+    file << std::fixed << std::setprecision(3) << "{\"traceEvents\":[\n";
+
+    flusher = std::thread([this]() {
+        while (running.load(std::memory_order_acquire))
+        {
+            drain();
+            std::this_thread::sleep_for(std::chrono::milliseconds(5));
+        }
+    });
+}
+
+inline Tracer::~Tracer()
+{
+    close();
+}
+
+inline double Tracer::now_us() const
+{
+    return std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - origin).count();
+}
+
+inline void Tracer::emit(char phase, const char *name, double ts_us, double dur_us, int line, long long count, const std::string &label)
+{
+    TraceEvent event;
+    event.phase = phase;
+    event.name = name;
+    event.ts_us = ts_us;
+    event.dur_us = dur_us;
+    event.line = line;
+    event.count = count;
+
+    std::size_t length = std::min(label.size(), sizeof(event.label) - 1);
+    std::memcpy(event.label, label.data(), length);
+    event.label[length] = '\0';
+
+    ring.push(event);
+}
+
+inline void Tracer::phase_begin(const char *name)
+{
+    emit('B', name, now_us(), 0, 0, -1, "");
+}
+
+inline void Tracer::phase_end(const char *name)
+{
+    emit('E', name, now_us(), 0, 0, -1, "");
+}
+
+inline void Tracer::complete(const char *name, double start_us, int line, long long count, const std::string &label)
+{
+    emit('X', name, start_us, now_us() - start_us, line, count, label);
+}
+
+inline void Tracer::instant(const char *name, int line, const std::string &label)
+{
+    emit('i', name, now_us(), 0, line, -1, label);
+}
+
+inline void Tracer::drain()
+{
+    TraceEvent event;
+    while (ring.pop(event))
+        write_event(event);
+
+    file.flush();
+}
+
+inline void Tracer::write_event(const TraceEvent &event)
+{
+    if (!first_event)
+        file << ",\n";
+    first_event = false;
+
+    file << "{\"ph\":\"" << event.phase << "\",\"name\":\"" << event.name << "\",\"pid\":1,\"tid\":1,\"ts\":" << event.ts_us;
+
+    if (event.phase == 'X')
+        file << ",\"dur\":" << event.dur_us;
+    if (event.phase == 'i')
+        file << ",\"s\":\"t\"";
+
+    file << ",\"args\":{";
+    bool comma = false;
+    if (event.line)
+    {
+        file << "\"line\":" << event.line;
+        comma = true;
+    }
+    if (event.count >= 0)
+    {
+        file << (comma ? "," : "") << "\"count\":" << event.count;
+        comma = true;
+    }
+    if (event.label[0])
+    {
+        //labels are identifiers made of letters, nothing in them needs escaping
+        file << (comma ? "," : "") << "\"label\":\"" << event.label << "\"";
+    }
+    file << "}}";
+}
+
+inline void Tracer::close()
+{
+    if (!running.exchange(false))
+        return;
+
+    flusher.join();
+    drain();
+
+    file << "\n],\"otherData\":{\"dropped_events\":" << ring.dropped() << "}}\n";
+    file.close();
+}
+
+//TRACING INTERPRETER
+
+inline TracingInterpreter::TracingInterpreter(Tracer &_tracer) : tracer(_tracer), loop_depth(0), traced_body(nullptr), iterations(0)
+{
+}
+
+inline void TracingInterpreter::visit(BlockCode *ast)
+{
+    if (ast == traced_body)
+        ++iterations;
+
+    Interpreter::visit(ast);
+}
+
+inline void TracingInterpreter::visit(While *ast)
+{
+    if (skip_mode || loop_depth > 0)
+    {
+        ++loop_depth;
+        Interpreter::visit(ast);
+        --loop_depth;
+        return;
+    }
+
+    traced_body = ast->bCode;
+    iterations = 0;
+    double start = tracer.now_us();
+
+    ++loop_depth;
+    Interpreter::visit(ast);
+    --loop_depth;
+
+    tracer.complete("WHILE", start, ast->line, iterations);
+    traced_body = nullptr;
+}
+
+inline void TracingInterpreter::visit(GoTo *ast)
+{
+    if (!skip_mode)
+        tracer.instant("GOTO", ast->line, ast->token.text_data);
+
+    Interpreter::visit(ast);
+}
+
+inline void TracingInterpreter::visit(ReadVar *ast)
+{
+    if (skip_mode)
+        return;
+
+    double start = tracer.now_us();
+    Interpreter::visit(ast);
+    tracer.complete("READ", start, ast->line, -1);
+}
+
+inline void TracingInterpreter::visit(ReadArr *ast)
+{
+    if (skip_mode)
+        return;
+
+    double start = tracer.now_us();
+    Interpreter::visit(ast);
+    tracer.complete("READ", start, ast->line, -1);
+}
+
+#endif
\ No newline at end of file
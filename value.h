@@ -0,0 +1,49 @@
+#pragma once
+
+#ifndef VALUE_HEADER
+#define VALUE_HEADER
+
+#include <stdexcept>
+#include <string>
+
+//every number the language works with; define BASIC_INT64 to build the interpreter with 64 bit values
+//or BASIC_BIGINT for integers of any size, or BASIC_NANBOX for integers and decimals in one 64 bit word
+#if defined(BASIC_BIGINT)
+#include "bignum.h"
+typedef Number value_t;
+#elif defined(BASIC_NANBOX)
+#include "boxed.h"
+typedef Boxed value_t;
+#elif defined(BASIC_INT64)
+typedef long long value_t;
+#else
+typedef int value_t;
+#endif
+
+//arithmetic used by the interpreter: the result is checked with the compiler's overflow builtins
+//and an overflow is reported as std::overflow_error instead of being undefined behaviour.
+//with BASIC_BIGINT nothing overflows, a result that does not fit 64 bits moves to the heap
+value_t value_add(const value_t &a, const value_t &b);
+value_t value_sub(const value_t &a, const value_t &b);
+value_t value_mul(const value_t &a, const value_t &b);
+value_t value_div(const value_t &a, const value_t &b);
+value_t value_mod(const value_t &a, const value_t &b);
+value_t value_neg(const value_t &a);
+
+//converts the decimal digits of a literal or an input line; a negative number takes its digits with the sign,
+//so the smallest value of the type can be read
+value_t value_from_digits(const char *begin, const char *end, bool negative = false);
+
+//converts a decimal literal such as 2.75, only BASIC_NANBOX builds have decimals
+value_t value_from_decimal(const std::string &literal);
+
+//converts to a machine integer for sizes and indexes, false when the value is out of range
+bool value_fits_long(const value_t &v, long long &result);
+//the other way round, for counts and positions computed by the interpreter itself
+value_t value_from_long(long long v);
+
+std::string value_to_string(const value_t &v);
+
+#include "value.inl"
+
+#endif
\ No newline at end of file
@@ -0,0 +1,247 @@
+#ifndef VALUE_SOURCE
+#define VALUE_SOURCE
+
+#include <cstdlib>
+#include <limits>
+
+#if defined(BASIC_BIGINT)
+
+//the small path and the promotion live in Number, these only keep the interface shared with the other modes
+inline value_t value_add(const value_t &a, const value_t &b)
+{
+    return Number::add(a, b);
+}
+
+inline value_t value_sub(const value_t &a, const value_t &b)
+{
+    return Number::sub(a, b);
+}
+
+inline value_t value_mul(const value_t &a, const value_t &b)
+{
+    return Number::mul(a, b);
+}
+
+inline value_t value_div(const value_t &a, const value_t &b)
+{
+    return Number::div(a, b);
+}
+
+inline value_t value_mod(const value_t &a, const value_t &b)
+{
+    return Number::mod(a, b);
+}
+
+inline value_t value_neg(const value_t &a)
+{
+    return Number::neg(a);
+}
+
+inline value_t value_from_digits(const char *begin, const char *end, bool negative)
+{
+    value_t number = 0;
+    for (const char *d = begin; d < end; ++d)
+        number = negative ? Number::sub(Number::mul(number, 10), *d - '0') : Number::add(Number::mul(number, 10), *d - '0');
+
+    return number;
+}
+
+inline bool value_fits_long(const value_t &v, long long &result)
+{
+    return v.fits_long(result);
+}
+
+inline value_t value_from_long(long long v)
+{
+    return Number(v);
+}
+
+inline std::string value_to_string(const value_t &v)
+{
+    return v.to_string();
+}
+
+inline value_t value_from_decimal(const std::string & /*literal*/)
+{
+    throw std::invalid_argument("decimal numbers need a BASIC_NANBOX build");
+}
+
+#elif defined(BASIC_NANBOX)
+
+inline value_t value_add(const value_t &a, const value_t &b)
+{
+    return Boxed::add(a, b);
+}
+
+inline value_t value_sub(const value_t &a, const value_t &b)
+{
+    return Boxed::sub(a, b);
+}
+
+inline value_t value_mul(const value_t &a, const value_t &b)
+{
+    return Boxed::mul(a, b);
+}
+
+inline value_t value_div(const value_t &a, const value_t &b)
+{
+    return Boxed::div(a, b);
+}
+
+inline value_t value_mod(const value_t &a, const value_t &b)
+{
+    return Boxed::mod(a, b);
+}
+
+inline value_t value_neg(const value_t &a)
+{
+    return Boxed::neg(a);
+}
+
+//18 digits are exact in a long long; longer numbers become doubles, converted as a whole like the decimals
+//so they are rounded only once
+inline value_t value_from_digits(const char *begin, const char *end, bool negative)
+{
+    if (end - begin <= 18)
+    {
+        long long number = 0;
+        for (const char *d = begin; d < end; ++d)
+            number = number * 10 + (*d - '0');
+
+        return Boxed::from_long(negative ? -number : number);
+    }
+
+    std::string literal(negative ? "-" : "");
+    literal.append(begin, end);
+    return Boxed::from_double(std::strtod(literal.c_str(), nullptr));
+}
+
+inline bool value_fits_long(const value_t &v, long long &result)
+{
+    return v.fits_long(result);
+}
+
+inline value_t value_from_long(long long v)
+{
+    return Boxed::from_long(v);
+}
+
+inline std::string value_to_string(const value_t &v)
+{
+    return v.to_string();
+}
+
+inline value_t value_from_decimal(const std::string &literal)
+{
+    return Boxed::from_double(std::strtod(literal.c_str(), nullptr));
+}
+
+#else
+
+//the overflow path is cold: a separate function keeps the throw out of the inlined arithmetic
+[[noreturn]] inline void value_overflow()
+{
+    throw std::overflow_error("integer overflow");
+}
+
+inline value_t value_add(const value_t &a, const value_t &b)
+{
+    value_t result;
+    if (__builtin_expect(__builtin_add_overflow(a, b, &result), 0))
+        value_overflow();
+
+    return result;
+}
+
+inline value_t value_sub(const value_t &a, const value_t &b)
+{
+    value_t result;
+    if (__builtin_expect(__builtin_sub_overflow(a, b, &result), 0))
+        value_overflow();
+
+    return result;
+}
+
+inline value_t value_mul(const value_t &a, const value_t &b)
+{
+    value_t result;
+    if (__builtin_expect(__builtin_mul_overflow(a, b, &result), 0))
+        value_overflow();
+
+    return result;
+}
+
+inline value_t value_div(const value_t &a, const value_t &b)
+{
+    if (b == 0)
+        throw std::invalid_argument("cant divide by zero!");
+
+    //the only quotient that does not fit
+    if (__builtin_expect(b == -1 && a == std::numeric_limits<value_t>::min(), 0))
+        value_overflow();
+
+    return a / b;
+}
+
+inline value_t value_mod(const value_t &a, const value_t &b)
+{
+    if (b == 0)
+        throw std::invalid_argument("cant divide by zero!");
+
+    if (b == -1)
+        return 0;
+
+    return a % b;
+}
+
+inline value_t value_neg(const value_t &a)
+{
+    value_t result;
+    if (__builtin_expect(__builtin_sub_overflow((value_t)0, a, &result), 0))
+        value_overflow();
+
+    return result;
+}
+
+inline value_t value_from_digits(const char *begin, const char *end, bool negative)
+{
+    value_t number = 0;
+    for (const char *d = begin; d < end; ++d)
+    {
+        value_t digit = *d - '0';
+        if (__builtin_expect(__builtin_mul_overflow(number, (value_t)10, &number) ||
+                                 (negative ? __builtin_sub_overflow(number, digit, &number) : __builtin_add_overflow(number, digit, &number)),
+                             0))
+            throw std::overflow_error("integer literal is too large");
+    }
+
+    return number;
+}
+
+inline bool value_fits_long(const value_t &v, long long &result)
+{
+    result = v;
+    return true;
+}
+
+inline value_t value_from_long(long long v)
+{
+    if (v != (value_t)v)
+        value_overflow();
+
+    return (value_t)v;
+}
+
+inline std::string value_to_string(const value_t &v)
+{
+    return std::to_string(v);
+}
+
+inline value_t value_from_decimal(const std::string & /*literal*/)
+{
+    throw std::invalid_argument("decimal numbers need a BASIC_NANBOX build");
+}
+
+#endif
+
+#endif
\ No newline at end of file